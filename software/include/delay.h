@@ -0,0 +1,25 @@
+#ifndef DELAY_H
+    #define DELAY_H 1
+
+    /**
+     * @brief Measures the cost of reading CLOCK_MONOTONIC_RAW so that delays
+     *        shorter than it do not spin. Called automatically by the first
+     *        delay if it has not been called already.
+     * @return long The measured overhead of reading the clock in nanoseconds.
+     */
+    long calibrateDelay(void);
+
+    /**
+     * @brief Gets the time used by the delays.
+     * @return long long CLOCK_MONOTONIC_RAW in nanoseconds.
+     */
+    long long getTimeNSec(void);
+
+    /**
+     * @brief Waits at least nsec nanoseconds by spinning on CLOCK_MONOTONIC_RAW.
+     *        Long delays sleep for most of the time and only spin at the end.
+     *        Delays shorter than the calibrated overhead read the clock once.
+     * @param nsec The number of nanoseconds to wait.
+     */
+    void delayNSec(long nsec);
+#endif
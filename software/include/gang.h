@@ -0,0 +1,38 @@
+#ifndef GANG_H
+    #define GANG_H 1
+    #include "piepro.h"
+
+    /**
+     * @brief Results of each I2C bus programmed by runGangI2C.
+     */
+    struct GANG_RESULT{
+        int numBuses;
+        int buses[MAX_I2C_BUSES];
+        int results[MAX_I2C_BUSES];
+        int byteWriteCounters[MAX_I2C_BUSES];
+        int byteReadCounters[MAX_I2C_BUSES];
+    };
+
+    /**
+     * @brief Writes, compares or erases the I2C EEPROMs on every bus in options at
+     *        once with a thread for each bus. Each bus gets a copy of the eeprom with
+     *        its own devices and write cycles. The file is opened by each bus. WP is
+     *        shared by every bus so it is pulled LOW before the threads start.
+     *        The byte counters of every bus are added to the eeprom.
+     * @param *options A pointer to the OPTIONS struct with the action, file and buses.
+     * @param *gpioConfig A pointer to the GPIO_CONFIG struct setup by initHardware.
+     * @param *eeprom A eeprom struct setup by initHardware for the first bus.
+     * @param *result A pointer to the GANG_RESULT struct to store the result of each bus in.
+     * @return int The total number of bytes that do not match for a compare and 0 for
+     *         a write or erase. -1 if any bus failed.
+     */
+    int runGangI2C(struct OPTIONS* options, struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, \
+                                                                                struct GANG_RESULT* result);
+
+    /**
+     * @brief Prints the result of each bus programmed by runGangI2C.
+     * @param *result A pointer to the GANG_RESULT struct filled by runGangI2C.
+     * @param action The action run on every bus.
+     */
+    void printGangResult(struct GANG_RESULT* result, int action);
+#endif
@@ -11,22 +11,137 @@
      */
     enum PIN_MODE {INPUT=0, OUTPUT};
 
+    /**
+     * @brief Backends used to drive the GPIO lines.
+     *        LIBGPIOD uses the kernel character device. Built against libgpiod v2
+     *        when GPIOD_V2 is defined and the v1 API otherwise.
+     *        GPIOMEM drives the BCM2711 GPIO registers directly via /dev/gpiomem.
+     *        SIM drives an in-process simulated EEPROM. See sim.h.
+     */
+    enum GPIO_BACKEND {LIBGPIOD=0, GPIOMEM, SIM, END_GPIO_BACKEND};
+
+    /**
+     * @brief Array of backend strings correlating to the GPIO_BACKEND enum.
+     */
+    extern const char* GPIO_BACKEND_STRINGS[];
+
+    #define MAX_BULK_LINES 16
+    #define BULK_LEVEL_SLICES (MAX_BULK_LINES/8)
+    #define REGISTER_SLICES 4
+    // The I2C bus on the built in SDA1 and SCL1 pins
+    #define DEFAULT_I2C_BUS 1
+    // Most bytes read in one I2C transaction. i2c-bcm2835 takes a single read message
+    // per transaction and i2c-dev limits a message to 8192 bytes
+    #define MAX_I2C_READ_LEN 8192
+
+    /**
+     * @brief A group of GPIO lines requested together so the whole group can
+     *        be driven or sampled with a single call. Bit N of a bulk value
+     *        corresponds to lines[N].
+     */
+    struct GPIO_BULK{
+        int isRequested;
+        int numLines;
+        int direction;
+        int lines[MAX_BULK_LINES];
+        int values[MAX_BULK_LINES];
+        unsigned int levels;
+
+        // Lookup tables built when the bulk is requested. Lines above 31 are not mapped
+        unsigned int lineMask;
+        // Byte N of levels to the GPIO register bits that are set
+        unsigned int setMasks[BULK_LEVEL_SLICES][256];
+        // Byte N of a GPIO level register to levels
+        unsigned short registerLevels[REGISTER_SLICES][256];
+
+        // libgpiod v2 request of every line in the bulk and its line configs
+        // indexed by direction so the bulk can be flipped with one reconfigure
+        struct gpiod_line_request* request;
+        struct gpiod_line_config* lineConfigs[2];
+    };
+
     struct GPIO_CHIP{
         // GPIO
         int isSetup;
         int numLinesInUse;
+        const struct GPIO_BACKEND_OPS* ops;
         struct gpiod_chip* chip;
         struct gpiod_line* gpioLines[40];
+        // libgpiod v2 requests and line configs of the lines that are not in a bulk
+        struct gpiod_line_request* lineRequests[40];
+        struct gpiod_line_config* lineConfigs[40][2];
+        struct gpiod_edge_event_buffer* edgeEventBuffer;
+        struct GPIO_BULK* lineBulk[40];
+        int lineBulkOffset[40];
+        // Shadow state of the lines that are not in a bulk
+        int lineModes[40];
+        int lineLevels[40];
+        // Lines with edge events requested
+        int lineEvents[40];
         
         int numGPIOLines;
         char *chipname;
         char *consumer;
+
+        // gpiomem
+        volatile unsigned int* gpioMem;
         
         // I2C
         int isI2CSetup;
         int fd;
     };
 
+    /**
+     * @brief Operations implemented by a GPIO backend. The public functions below
+     *        validate their arguments before calling into a backend so backends
+     *        can assume valid lines, modes and levels. Line directions are kept
+     *        in the GPIO_CHIP so backends do not need to query them.
+     */
+    struct GPIO_BACKEND_OPS{
+        // GPIO
+        int (*setupGPIO)(struct GPIO_CHIP* gpioChip);
+        int (*setPinModeGPIO)(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int pinMode);
+        int (*readGPIO)(struct GPIO_CHIP* gpioChip, int gpioLineNumber);
+        int (*writeGPIO)(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level);
+        void (*cleanupGPIO)(struct GPIO_CHIP* gpioChip);
+
+        // Bulk
+        int (*requestBulkGPIO)(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk);
+        int (*setBulkModeGPIO)(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int direction);
+        int (*readBulkGPIO)(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk);
+        int (*writeBulksGPIO)(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, int numBulks);
+        void (*releaseBulkGPIO)(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk);
+
+        // Edge events. Optional, NULL if the backend cannot wait on edges
+        int (*requestEventsGPIO)(struct GPIO_CHIP* gpioChip, int gpioLineNumber);
+        int (*waitEventGPIO)(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int timeoutMSec);
+        void (*releaseEventsGPIO)(struct GPIO_CHIP* gpioChip, int gpioLineNumber);
+
+        // I2C
+        int (*setupI2C)(int bus, char I2CId);
+        int (*readI2C)(int fd, char* buf, int numBytesToRead, int addressSize);
+        int (*writeI2C)(int fd, char* data, int numBytesToWrite);
+        void (*cleanupI2C)(int fd);
+    };
+
+    /**
+     * @brief The simulated EEPROM backend. Defined in sim.c.
+     */
+    extern const struct GPIO_BACKEND_OPS SIM_BACKEND_OPS;
+
+    /**
+     * @brief Sets the backend used by GPIO chips that are setup afterwards.
+     * @param backend The GPIO_BACKEND to use. Default: LIBGPIOD
+     * @return int 0 if successful -1 if the backend is invalid.
+     */
+    int setBackendGPIO(int backend);
+
+    /**
+     * @brief Gets the backend used by newly setup GPIO chips.
+     * @return int The GPIO_BACKEND in use.
+     */
+    int getBackendGPIO(void);
+
     /**
      * @brief Setups Raspberry Pi GPIO Pins.
      *        Must be called before any GPIO is used.
@@ -36,7 +151,8 @@
     int setupGPIO(struct GPIO_CHIP* gpioChip);
 
     /**
-     * @brief Set GPIO Pins to input or output.
+     * @brief Set GPIO Pins to input or output. Nothing is changed if the pin
+     *        is already in the requested mode.
      * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
      * @param gpioLineNumber the GPIO number to be control direction.
      * @param direction The mode of the GPIO Pin. INPUT or OUTPUT
@@ -60,7 +176,133 @@
      * @return int 0 if successful -1 or non-zero if any error occurs.
      */
     int writeGPIO(struct GPIO_CHIP* gpioChip,int gpioLineNumber,int level);
+
+    /**
+     * @brief Read the value of the specified GPIO Pin without validating the chip,
+     *        line or mode. Only use with lines that have already been validated.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param gpioLineNumber the GPIO number to be read from.
+     * @return int The level of the line. -1 if any error occurs.
+     */
+    int readGPIOUnchecked(struct GPIO_CHIP* gpioChip, int gpioLineNumber);
+
+    /**
+     * @brief Write the value to the specified GPIO Pin without validating the chip,
+     *        line, mode or level. Only use with lines that have already been validated.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param gpioLineNumber the GPIO number to be written to.
+     * @param level The value to write. HIGH or LOW.
+     * @return int 0 if successful -1 or non-zero if any error occurs.
+     */
+    int writeGPIOUnchecked(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level);
     
+    /**
+     * @brief Requests a group of GPIO lines together so they can be set or read
+     *        with one call. Lines in a bulk may still be used with readGPIO and
+     *        writeGPIO but their direction can only be changed with setBulkModeGPIO.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param *bulk Pointer to the GPIO_BULK struct to be populated.
+     * @param *gpioLineNumbers Array of the GPIO numbers to group. Bit N maps to gpioLineNumbers[N].
+     * @param numLines The number of lines in gpioLineNumbers. Max MAX_BULK_LINES.
+     * @param direction The mode of the lines. INPUT or OUTPUT
+     * @param levels The initial levels of the lines if direction is OUTPUT.
+     * @return int 0 if successful -1 if any error occurs.
+     */
+    int requestBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int* gpioLineNumbers, \
+                                                            int numLines, int direction, unsigned int levels);
+
+    /**
+     * @brief Set all the lines of a bulk to input or output.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param *bulk Pointer to the requested GPIO_BULK.
+     * @param direction The mode of the lines. INPUT or OUTPUT
+     * @return int 0 if successful -1 if any error occurs.
+     */
+    int setBulkModeGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int direction);
+
+    /**
+     * @brief Read the value of every line in a bulk.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param *bulk Pointer to the requested GPIO_BULK.
+     * @return int The levels of the lines with bit N set from line N. -1 if any error occurs.
+     */
+    int readBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk);
+
+    /**
+     * @brief Write the levels of every line in a bulk.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param *bulk Pointer to the requested GPIO_BULK.
+     * @param levels The levels to write with bit N driving line N.
+     * @return int 0 if successful -1 if any error occurs.
+     */
+    int writeBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, unsigned int levels);
+
+    /**
+     * @brief Write the levels of several bulks at once. With the GPIOMEM backend
+     *        all of the bulks are driven with a single set and clear register pair.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param **bulks Array of pointers to the requested GPIO_BULKs.
+     * @param *levels Array of the levels to write to each bulk.
+     * @param numBulks The number of bulks to write.
+     * @return int 0 if successful -1 if any error occurs.
+     */
+    int writeBulksGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, unsigned int* levels, int numBulks);
+
+    /**
+     * @brief Read the value of every line in a bulk without validating the chip,
+     *        bulk or direction.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param *bulk Pointer to the requested GPIO_BULK.
+     * @return int The levels of the lines with bit N set from line N. -1 if any error occurs.
+     */
+    int readBulkGPIOUnchecked(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk);
+
+    /**
+     * @brief Write the levels of several bulks at once without validating the chip,
+     *        bulks or directions. Nothing is written if no level changes.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param **bulks Array of pointers to the requested GPIO_BULKs.
+     * @param *levels Array of the levels to write to each bulk.
+     * @param numBulks The number of bulks to write.
+     * @return int 0 if successful -1 if any error occurs.
+     */
+    int writeBulksGPIOUnchecked(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, unsigned int* levels, int numBulks);
+
+    /**
+     * @brief Releases a bulk and requests its lines individually as OUTPUT again.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param *bulk Pointer to the requested GPIO_BULK.
+     */
+    void releaseBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk);
+
+    /**
+     * @brief Requests edge events on an INPUT line so that waitLevelGPIO can sleep
+     *        until the line changes instead of polling it. The mode of the line
+     *        cannot be changed until the events are released.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param gpioLineNumber the GPIO number to request edge events on.
+     * @return int 0 if successful -1 if any error occurs or the backend has no edge events.
+     */
+    int requestEventsGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber);
+
+    /**
+     * @brief Waits until an INPUT line is at a level. Sleeps on edge events if they
+     *        are requested on the line and polls the line otherwise.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param gpioLineNumber the GPIO number to wait on.
+     * @param level The level to wait for. HIGH or LOW.
+     * @param timeoutMSec The longest time to wait in milliseconds.
+     * @return int 0 if the line is at the level. 1 if the wait timed out. -1 if any error occurs.
+     */
+    int waitLevelGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level, int timeoutMSec);
+
+    /**
+     * @brief Releases the edge events of a line. The line stays an INPUT.
+     * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
+     * @param gpioLineNumber the GPIO number to release edge events from.
+     */
+    void releaseEventsGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber);
+
     /**
      * @brief Releases a gpiod_chip and an array of gpiod_lines.
      * @param *gpioChip Pointer to the GPIO_CHIP struct to be used
@@ -68,28 +310,36 @@
     void cleanupGPIO(struct GPIO_CHIP* gpioChip);
 
     /**
-     * @brief Sets up GPIO pins to use the dedicated I2C function.
+     * @brief Sets up an I2C device on /dev/i2c-N. The built in I2C pins are set to
+     *        their I2C function for DEFAULT_I2C_BUS. Other buses such as i2c-gpio
+     *        buses have their pins set up by the kernel.
+     * @param bus The number N of the I2C bus. Default DEFAULT_I2C_BUS.
      * @param I2CId The address of the I2C device. Default 0x50.
      * @return int The file descriptor of the I2C device. -1 if error.
      */
-    int setupI2C(char I2CId);
+    int setupI2C(int bus, char I2CId);
 
     /**
-     * @brief Reads a byte via the I2C bus.
+     * @brief Reads bytes from consecutive addresses via the I2C bus. The address is
+     *        written and the bytes are read back in one transaction with a repeated
+     *        start where the I2C adapter supports it.
      * @param fd The file descriptor of the I2C device to be used.
-     * @param buf* Buffer for the bytes that are read.
-     * @param numBytesToRead The number of bytes to read including the address.
+     * @param buf* Buffer holding the address to read from. Also receives the bytes read.
+     * @param numBytesToRead The number of bytes to read. Not limited to a page but
+     *        at most MAX_I2C_READ_LEN.
      * @param addressSize The number of bytes of the address.
      * @return int Number of bytes read from the I2C device or -1 if error.
      */
     int readI2C(int fd, char* buf, int numBytesToRead, int addressSize);
     
     /**
-     * @brief Writes a byte via the I2C bus.
+     * @brief Writes a byte via the I2C bus. Writing no bytes only checks that the
+     *        device acknowledges its I2C id which is used for acknowledge polling.
      * @param fd The file descriptor of the I2C device to be used.
      * @param data* The data to be written.
      * @param numBytesToWrite The number of bytes to write including the address.
-     * @return int number of bytes writen if successful -1 if any error occurs.
+     * @return int number of bytes writen if successful -1 if any error occurs or
+     *         the device does not acknowledge. Not acknowledging is not logged.
      */
     int writeI2C(int fd, char* data, int numBytesToWrite);
 
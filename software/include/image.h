@@ -0,0 +1,61 @@
+#ifndef IMAGE_H
+    #define IMAGE_H 1
+    #include <stdio.h>
+
+    /**
+     * @brief Most bytes of a pipe held in memory at once.
+     */
+    #define IMAGE_BUFFER_SIZE 65536
+
+    /**
+     * @brief Bytes of room kept in front of the buffer of a streamed image. Enough
+     *        for the address an I2C EEPROM puts in front of the bytes it writes.
+     */
+    #define IMAGE_HEADROOM 2
+
+    /**
+     * @brief The contents of a binary file. Regular files are mapped into memory.
+     *        Pipes and other files that cannot be mapped are streamed through a
+     *        buffer of IMAGE_BUFFER_SIZE bytes as they are read. The buffer has
+     *        IMAGE_HEADROOM bytes of room in front of it.
+     */
+    struct IMAGE{
+        char* data;
+        long address;
+        long size;
+        int isMapped;
+        FILE* stream;
+    };
+
+    /**
+     * @brief Maps a binary file from its start or sets up a pipe to be streamed
+     *        from where it is. Nothing is read from a pipe until it is needed.
+     * @param *romFile The file to load.
+     * @param *image A pointer to the IMAGE struct to load the file into.
+     * @return int 0 if successful -1 if any error occurs.
+     */
+    int openImage(FILE* romFile, struct IMAGE* image);
+
+    /**
+     * @brief Gets the bytes of the image starting at an address. A streamed
+     *        image waits for the bytes to be read from the pipe. It can not go
+     *        back to the bytes before the address of the last call and returns
+     *        at most IMAGE_BUFFER_SIZE bytes.
+     * @param *image A pointer to the IMAGE struct to get the bytes from.
+     * @param address The address of the first byte.
+     * @param numBytes The most bytes to get.
+     * @param **bytes Set to point to the bytes. They are only valid until the
+     *        next call. The bytes of a mapped image must not be changed. Those of
+     *        a streamed image may be and have IMAGE_HEADROOM bytes in front of
+     *        them that may be borrowed as long as they are put back.
+     * @return int The number of bytes available at address up to numBytes. 0 at
+     *         the end of the image. -1 if any error occurs.
+     */
+    int getImageBytes(struct IMAGE* image, long address, int numBytes, char** bytes);
+
+    /**
+     * @brief Unmaps or frees the contents of the image.
+     * @param *image A pointer to the IMAGE struct to close.
+     */
+    void closeImage(struct IMAGE* image);
+#endif
@@ -1,5 +1,6 @@
 #ifndef PIEPRO_H
     #define PIEPRO_H 1
+    #include <stdio.h>
     #include "gpio.h"
     
     #define MAJOR "1"
@@ -9,13 +10,17 @@
 
     #define MAX_ADDRESS_PINS 16
     #define MAX_DATA_PINS 8
+    #define MAX_I2C_DEVICES 8
+    #define MAX_I2C_BUSES 8
+    #define MAX_ERASED_PAGES 1024
 
     /**
      * @brief Enumeration of the different supported EEProm models.
      */
     enum EEPROM_MODEL {XL2816,XL28C16,
                         AT28C16,AT28C64,AT28C256,
-                        AT24C01,AT24C02,AT24C04,AT24C08,AT24C16,AT24C32,AT24C64,AT24C128,AT24C256,AT24C512,END};
+                        AT24C01,AT24C02,AT24C04,AT24C08,AT24C16,AT24C32,AT24C64,AT24C128,AT24C256,AT24C512,
+                        AT24CM01,AT24CM02,END};
 
     /**
      * @brief Enumeration of the different types of supported EEProm protocols.
@@ -32,6 +37,14 @@
      */
     enum PRINT_FORMAT {PRETTY_WITH_ASCII=0,BINARY,TEXT,LABELED,PRETTY};
 
+    /**
+     * @brief Defines how the end of a parallel write cycle is detected when polling.
+     *        DATA_POLLING waits for I/O7 to match the last byte written.
+     *        TOGGLE_BIT_POLLING waits for I/O6 to stop toggling between reads.
+     *        READY_BUSY_POLLING sleeps until the RDY/BUSY pin goes back HIGH.
+     */
+    enum POLLING_METHOD {DATA_POLLING=0, TOGGLE_BIT_POLLING, READY_BUSY_POLLING, END_POLLING_METHOD};
+
     /**
      * @brief Defines the supported functions of the programmer.
      */
@@ -77,6 +90,73 @@
      */
     extern const int   EEPROM_WRITE_CYCLE_USEC[];
 
+    /**
+     * @brief Array of EEProm model default polling methods correlating to the EEProm models.
+     */
+    extern const int   EEPROM_POLLING_METHOD[];
+
+    /**
+     * @brief Array of polling method strings correlating to the POLLING_METHOD enum.
+     */
+    extern const char* POLLING_METHOD_STRINGS[];
+
+    /**
+     * @brief Array of EEProm model page sizes correlating to the EEProm models.
+     */
+    extern const int   EEPROM_PAGE_SIZE[];
+
+    /**
+     * @brief Array of whether EEProm models latch a page of bytes in one write cycle correlating to the EEProm models.
+     */
+    extern const int   EEPROM_PAGE_WRITE[];
+
+    /**
+     * @brief Array of EEProm model chip erase times(tEC) in microseconds correlating to the EEProm models.
+     *        0 for models without the JEDEC software chip erase.
+     */
+    extern const int   EEPROM_CHIP_ERASE_USEC[];
+
+    /**
+     * @brief Array of EEProm model I2C address byte counts correlating to the EEProm models.
+     */
+    extern const int   EEPROM_ADDRESS_SIZE[];
+
+    /**
+     * @brief Array of the number of I2C ids each EEProm model answers to correlating to the EEProm models.
+     *        The address bits above the address bytes are sent in the low bits of the I2C id.
+     */
+    extern const int   EEPROM_I2C_BLOCKS[];
+
+    /**
+     * @brief Array of EEProm model address setup times(tAS) in nanoseconds correlating to the EEProm models.
+     */
+    extern const int   EEPROM_ADDRESS_SETUP_NSEC[];
+
+    /**
+     * @brief Array of EEProm model write pulse widths(tWP) in nanoseconds correlating to the EEProm models.
+     */
+    extern const int   EEPROM_WRITE_PULSE_NSEC[];
+
+    /**
+     * @brief Array of EEProm model data setup times(tDS) in nanoseconds correlating to the EEProm models.
+     */
+    extern const int   EEPROM_DATA_SETUP_NSEC[];
+
+    /**
+     * @brief Array of EEProm model output enable to output delays(tOE) in nanoseconds correlating to the EEProm models.
+     */
+    extern const int   EEPROM_OUTPUT_ENABLE_NSEC[];
+
+    /**
+     * @brief Array of EEProm model address to output delays(tACC) in nanoseconds correlating to the EEProm models.
+     */
+    extern const int   EEPROM_ADDRESS_ACCESS_NSEC[];
+
+    /**
+     * @brief Array of EEProm model power up times in microseconds correlating to the EEProm models.
+     */
+    extern const int   EEPROM_POWER_UP_USEC[];
+
     /**
      * @struct OPTIONS
      * @brief This structure contains all the configuration parameters for a given
@@ -90,13 +170,19 @@
         int dumpFormat;
         int validateWrite;
         int force;
+        int eraseFirst;
         int action;
         int fileType;
         int eepromModel;
         int writeCycleUSec;
         int useWriteCyclePolling;
+        int pollingMethod;
+        int writeTimeoutMSec;
+        int useProfile;
+        char* profileFile;
         int boardType;
         int quick;
+        int useGrayCode;
         int readChunk;
         int promptUser;
         // Single Read/Write Parameters
@@ -104,10 +190,17 @@
         int dataParam;
         // I2C Specific
         char i2cId;
+        int numI2CDevices;
+        int i2cBuses[MAX_I2C_BUSES];
+        int numI2CBuses;
         char* consumer;
         char* chipname;
         int numGPIOLines;
+        int gpioBackend;
         char eraseByte;
+        // Real-Time
+        int useRealTime;
+        int realTimeCPU;
         };  
 
     /**
@@ -123,24 +216,58 @@
         int writeEnablePin;
         int outputEnablePin;
         int chipEnablePin;
+        int readyBusyPin;
         int vccPin;
+        struct GPIO_BULK addressBus;
+        struct GPIO_BULK dataBus;
+        struct GPIO_BULK controlBus;
+        int lastAddress;
+        // Bus timing in nanoseconds
+        int addressSetupTime;
+        int writePulseTime;
+        int dataSetupTime;
+        int outputEnableTime;
+        int addressAccessTime;
         int writeCycleTime;
         int useWriteCyclePolling;
+        int pollingMethod;
+        int writeTimeout;
+        char* profileFile;
+        int useLearnedDelay;
+        long delayedCycles;
         int limit;
         int startValue;
         int fileType;
         int quick;
+        int useGrayCode;
         int readChunk;
+        // Erase with eraseByte before writing a file
+        int eraseFirst;
+        char eraseByte;
+        // A bit for each page read back as erasedByte by an erase. Cleared when the page is written
+        unsigned char erasedPages[MAX_ERASED_PAGES / 8];
+        char erasedByte;
         
         int size;
         int maxAddressLength;
         int maxDataLength;
 
         // I2C
-        int fd;
+        int i2cBus;
         int i2cId;
+        // I2C EEPROMs written together at consecutive ids from i2cId. i2cReadDevice is the one read
+        int numI2CDevices;
+        int i2cReadDevice;
+        // Ids of each device that select a block of its addresses. A fd for each id in use
+        int numI2CBlocks;
+        int i2cFds[MAX_I2C_DEVICES];
+        // Start of each I2C write cycle not acknowledged yet. 0 if there is none
+        long long writeCycleStarts[MAX_I2C_DEVICES];
         char writeProtectPin;
+        // Set once WP is pulled LOW so it is not driven again for every page
+        int isWriteProtectDisabled;
         int pageSize;
+        int usePageWrite;
         int addressSize;
 
         // Info
@@ -167,6 +294,19 @@
      * @return int 0 if successful. Non-zero if error.
      */
     int initHardware(struct OPTIONS *options, struct EEPROM* eeprom, struct GPIO_CONFIG* gpioChip);
+
+    /**
+     * @brief Opens every I2C EEPROM of the eeprom on the eeprom's I2C bus.
+     * @param *eeprom A eeprom struct that contains the eeprom info.
+     * @return int 0 if successful. -1 if any device cannot be opened.
+     */
+    int openI2CDevices(struct EEPROM* eeprom);
+
+    /**
+     * @brief Closes every I2C EEPROM opened by openI2CDevices.
+     * @param *eeprom A eeprom struct that contains the eeprom info.
+     */
+    void closeI2CDevices(struct EEPROM* eeprom);
     
     /**
      * @brief Compares a file to the EEPROM given the specified options.
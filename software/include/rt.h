@@ -0,0 +1,67 @@
+#ifndef RT_H
+    #define RT_H 1
+    #include <time.h>
+
+    /**
+     * @brief Priority used for bus operations while in real-time mode.
+     */
+    #define RT_PRIORITY 80
+
+    /**
+     * @brief Counters kept while in real-time mode.
+     */
+    struct RT_STATS{
+        long sections;
+        long overruns;
+        long maxOverrunNSec;
+        long preemptions;
+    };
+
+    /**
+     * @brief Sets up real-time mode. Locks the memory of the process, pins the
+     *        calling thread to a CPU and checks that it may use SCHED_FIFO.
+     *        Must be called before enterRealTime has any effect.
+     * @param cpu The CPU to pin the thread to. -1 uses the last online CPU.
+     * @return int 0 if successful -1 if any error occurs.
+     */
+    int setupRealTime(int cpu);
+
+    /**
+     * @brief Raises the calling thread to SCHED_FIFO for a bus operation.
+     *        Does nothing if real-time mode is not setup. Calls may be nested.
+     * @return int 0 if successful -1 if any error occurs.
+     */
+    int enterRealTime(void);
+
+    /**
+     * @brief Returns the calling thread to the scheduling policy it had before
+     *        enterRealTime. Preemptions during the operation are counted.
+     */
+    void exitRealTime(void);
+
+    /**
+     * @brief Records an overrun if more than budgetNSec has passed since start.
+     *        Does nothing if real-time mode is not setup.
+     * @param *start The CLOCK_MONOTONIC time the timed section started.
+     * @param budgetNSec The longest the section may take in nanoseconds.
+     * @return int 1 if the section overran. 0 otherwise.
+     */
+    int checkOverrunRealTime(struct timespec* start, long budgetNSec);
+
+    /**
+     * @brief Returns whether real-time mode is setup.
+     * @return int 1 if real-time mode is setup. 0 otherwise.
+     */
+    int isRealTime(void);
+
+    /**
+     * @brief Gets the counters kept while in real-time mode.
+     * @param *stats A pointer to the RT_STATS struct to copy the counters into.
+     */
+    void getStatsRealTime(struct RT_STATS* stats);
+
+    /**
+     * @brief Reports any overruns, unlocks memory and leaves real-time mode.
+     */
+    void cleanupRealTime(void);
+#endif
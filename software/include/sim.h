@@ -0,0 +1,55 @@
+#ifndef SIM_H
+    #define SIM_H 1
+    #include "piepro.h"
+
+    /**
+     * @brief Counters kept by the simulated EEPROM backend.
+     */
+    struct SIM_STATS{
+        long gpioOps;
+        long i2cOps;
+        long writeCycles;
+        long bytesLoaded;
+        long ignoredWrites;
+    };
+
+    /**
+     * @brief Wires a simulated EEPROM of the eeprom's model to the pins of the eeprom.
+     *        Parallel EEPROMs are attached to the address, data and control pins.
+     *        I2C EEPROMs are added at the I2C id of each of the eeprom's devices on the
+     *        eeprom's I2C bus. The contents of a simulated EEPROM are kept between connections of
+     *        the same model.
+     * @param *eeprom A eeprom struct that contains the eeprom info.
+     * @return int 0 if successful. -1 if error.
+     */
+    int connectEEPROMSim(struct EEPROM* eeprom);
+
+    /**
+     * @brief Adds a simulated I2C EEPROM to a bus.
+     * @param model The EEPROM model to simulate. Must be an I2C model.
+     * @param bus The number N of the simulated /dev/i2c-N bus. 0 through 7.
+     * @param i2cId The I2C id of the device. 0x50 through 0x57. Models that take high
+     *        address bits in the I2C id also answer to the ids of their other blocks
+     *        so the id must be a multiple of the number of blocks from 0x50.
+     * @return int 0 if successful. -1 if error.
+     */
+    int addI2CDeviceSim(int model, int bus, int i2cId);
+
+    /**
+     * @brief Sets the write cycle time of every simulated EEPROM.
+     * @param usec The write cycle time in microseconds. -1 uses the model's
+     *        write cycle time, or a typical 1 ms for the AT28C256.
+     */
+    void setWriteCycleTimeSim(int usec);
+
+    /**
+     * @brief Gets the counters kept by the simulated EEPROM backend.
+     * @param *stats A pointer to the SIM_STATS struct to copy the counters into.
+     */
+    void getStatsSim(struct SIM_STATS* stats);
+
+    /**
+     * @brief Resets the counters kept by the simulated EEPROM backend.
+     */
+    void resetStatsSim(void);
+#endif
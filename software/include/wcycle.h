@@ -0,0 +1,122 @@
+#ifndef WCYCLE_H
+    #define WCYCLE_H 1
+
+    /**
+     * @brief Number of buckets the observed write cycle times are counted in.
+     */
+    #define WRITE_CYCLE_BUCKETS 64
+
+    /**
+     * @brief Write cycle times observed while polling.
+     */
+    struct WRITE_CYCLE_STATS{
+        long cycles;
+        long long minNSec;
+        long long maxNSec;
+        long long totalNSec;
+        long long estimateNSec;
+        long long sleptNSec;
+        long long bucketNSec;
+        long histogram[WRITE_CYCLE_BUCKETS];
+    };
+
+    /**
+     * @brief Write cycle times of a model kept between runs in a profile file.
+     */
+    struct WRITE_CYCLE_PROFILE{
+        long cycles;
+        long long bucketNSec;
+        long long maxNSec;
+        long histogram[WRITE_CYCLE_BUCKETS];
+    };
+
+    /**
+     * @brief Forgets every observed write cycle and starts a new estimate.
+     * @param maxNSec The longest a write cycle should take. Sets the range of the
+     *        histogram. Longer write cycles are counted in the last bucket.
+     */
+    void setupWriteCycle(long long maxNSec);
+
+    /**
+     * @brief Gets how long to sleep before polling for the end of a write cycle.
+     *        Most of the estimated write cycle is slept so polling only spins for
+     *        the tail. Nothing is slept until enough write cycles are observed.
+     * @return long long The number of nanoseconds to sleep.
+     */
+    long long getSleepWriteCycle(void);
+
+    /**
+     * @brief Sleeps on CLOCK_MONOTONIC until the time given by getSleepWriteCycle
+     *        has passed since the start of the write cycle.
+     * @param startNSec The time from getTimeNSec the write cycle started at.
+     */
+    void sleepWriteCycle(long long startNSec);
+
+    /**
+     * @brief Records the time a polled write cycle took and updates the estimate.
+     * @param elapsedNSec The nanoseconds from the start of the write cycle until
+     *        polling saw it finish.
+     * @param finishedAsleep 1 if the first poll after sleepWriteCycle already saw
+     *        the write cycle finished. Only the sleep is recorded since the
+     *        write cycle finished some time during it.
+     */
+    void recordWriteCycle(long long elapsedNSec, int finishedAsleep);
+
+    /**
+     * @brief Gets a percentile of the observed write cycle times.
+     * @param percent The percentile to get. 0 through 100.
+     * @return long long The upper edge of the bucket the percentile is in limited
+     *         to the longest write cycle observed. 0 if none were observed.
+     */
+    long long getPercentileWriteCycle(int percent);
+
+    /**
+     * @brief Gets the observed write cycle times.
+     * @param *stats A pointer to the WRITE_CYCLE_STATS struct to copy the times into.
+     */
+    void getStatsWriteCycle(struct WRITE_CYCLE_STATS* stats);
+
+    /**
+     * @brief Reports the distribution of the observed write cycle times.
+     */
+    void reportWriteCycle(void);
+
+    /**
+     * @brief Gets the default profile file. $XDG_CACHE_HOME/piepro/write-cycles
+     *        or ~/.cache/piepro/write-cycles if XDG_CACHE_HOME is not set.
+     * @return char* The path of the default profile file. NULL if there is no home.
+     */
+    char* getDefaultProfileWriteCycle(void);
+
+    /**
+     * @brief Loads the profile of a model from a profile file. Must be called after
+     *        setupWriteCycle. Profiles with a different histogram range are ignored.
+     * @param *filename The path of the profile file.
+     * @param *model The name of the model whose profile is loaded.
+     * @return int 0 if a profile was loaded. -1 if there is none.
+     */
+    int loadProfileWriteCycle(const char* filename, const char* model);
+
+    /**
+     * @brief Adds the write cycles observed in this run to the profile of a model
+     *        and saves it to a profile file. Profiles of other models are kept.
+     * @param *filename The path of the profile file. Missing directories are created.
+     * @param *model The name of the model whose profile is saved.
+     * @return int 0 if successful. -1 if any error occurs.
+     */
+    int saveProfileWriteCycle(const char* filename, const char* model);
+
+    /**
+     * @brief Gets a write cycle delay learned from the loaded profile. It is the
+     *        99th percentile of the profile with a margin on top.
+     * @return long long The learned delay in nanoseconds. 0 if the profile has too
+     *         few write cycles to be trusted.
+     */
+    long long getLearnedDelayWriteCycle(void);
+
+    /**
+     * @brief Gets the loaded profile.
+     * @param *profile A pointer to the WRITE_CYCLE_PROFILE struct to copy the profile into.
+     */
+    void getProfileWriteCycle(struct WRITE_CYCLE_PROFILE* profile);
+#endif
@@ -0,0 +1,57 @@
+#include <time.h>
+
+#include "delay.h"
+#include "ulog.h"
+
+#define NSEC_PER_SEC 1000000000L
+#define CALIBRATION_SAMPLES 1000
+// Delays longer than this sleep first since the scheduler wakes up late
+#define SLEEP_THRESHOLD_NSEC 200000L
+
+static long clockOverheadNSec = -1;
+
+/* Returns CLOCK_MONOTONIC_RAW in nanoseconds */
+long long getTimeNSec(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (long long)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/* Measures the smallest cost of reading the clock */
+long calibrateDelay(){
+    long long last = getTimeNSec();
+    long overhead = NSEC_PER_SEC;
+
+    for(int i = 0; i < CALIBRATION_SAMPLES; i++){
+        long long now = getTimeNSec();
+        if(now - last < overhead){
+            overhead = now - last;
+        }
+        last = now;
+    }
+    clockOverheadNSec = overhead;
+    ulog(DEBUG,"Calibrated delay clock overhead: %li ns",clockOverheadNSec);
+    return clockOverheadNSec;
+}
+
+/* Waits at least nsec nanoseconds */
+void delayNSec(long nsec){
+    if(clockOverheadNSec == -1){
+        calibrateDelay();
+    }
+    // Reading the clock once already takes at least this long
+    if(nsec <= clockOverheadNSec){
+        getTimeNSec();
+        return;
+    }
+
+    long long deadline = getTimeNSec() + nsec;
+    if(nsec > SLEEP_THRESHOLD_NSEC){
+        struct timespec sleepTime = {
+            .tv_sec = (nsec - SLEEP_THRESHOLD_NSEC) / NSEC_PER_SEC,
+            .tv_nsec = (nsec - SLEEP_THRESHOLD_NSEC) % NSEC_PER_SEC
+        };
+        nanosleep(&sleepTime, NULL);
+    }
+    while(getTimeNSec() < deadline);
+}
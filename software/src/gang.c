@@ -0,0 +1,155 @@
+#include <pthread.h>
+#include <stdio.h>
+
+#include "gang.h"
+#include "gpio.h"
+#include "piepro.h"
+#include "sim.h"
+#include "ulog.h"
+
+/* A bus programmed by its own thread */
+struct GANG_WORKER{
+    pthread_t thread;
+    struct OPTIONS* options;
+    struct GPIO_CONFIG* gpioConfig;
+    struct EEPROM eeprom;
+    int isOpen;
+    int result;
+};
+
+static pthread_mutex_t gangLock = PTHREAD_MUTEX_INITIALIZER;
+static int numFinished = 0;
+
+/* Runs the action of the options on the EEPROMs of one bus */
+void* runWorkerGang(void* arg){
+    struct GANG_WORKER* worker = arg;
+    struct OPTIONS* options = worker->options;
+    struct EEPROM* eeprom = &worker->eeprom;
+    FILE* romFile = NULL;
+
+    worker->result = -1;
+    if(options->action != ERASE_ROM){
+        romFile = fopen(options->filename, "r");
+        if(romFile == NULL){
+            ulog(ERROR,"Bus %i: Unable to open %s",eeprom->i2cBus,options->filename);
+            return NULL;
+        }
+    }
+    switch(options->action){
+        case WRITE_FILE_TO_ROM:
+            worker->result = writeFileToEEPROM(worker->gpioConfig, eeprom, romFile);
+            break;
+        case COMPARE_FILE_TO_ROM:
+            worker->result = compareFileToEEPROM(worker->gpioConfig, eeprom, romFile);
+            break;
+        case ERASE_ROM:
+            worker->result = eraseEEPROM(worker->gpioConfig, eeprom, options->eraseByte);
+            break;
+    }
+    if(romFile != NULL){
+        fclose(romFile);
+    }
+
+    pthread_mutex_lock(&gangLock);
+    numFinished++;
+    ulog(INFO,"Bus %i finished with %i bytes written and %i bytes read. %i of %i buses finished", \
+                    eeprom->i2cBus, eeprom->byteWriteCounter, eeprom->byteReadCounter, \
+                    numFinished, options->numI2CBuses);
+    pthread_mutex_unlock(&gangLock);
+    return NULL;
+}
+
+/* Starts a thread for each bus and adds up their results once every bus is finished */
+int runGangI2C(struct OPTIONS* options, struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, \
+                                                                                struct GANG_RESULT* result){
+    struct GANG_WORKER workers[MAX_I2C_BUSES];
+    int error = 0;
+    int bytesNotMatched = 0;
+
+    result->numBuses = 0;
+    if(eeprom->type != I2C){
+        ulog(ERROR,"Only I2C EEPROMs can be programmed on several buses");
+        return -1;
+    }
+    if(options->action != WRITE_FILE_TO_ROM && options->action != COMPARE_FILE_TO_ROM && \
+                                                                        options->action != ERASE_ROM){
+        ulog(ERROR,"Only writes, compares and erases can be run on several buses");
+        return -1;
+    }
+
+    // Every bus gets its own devices. The bus setup by initHardware keeps its own
+    for(int i = 0; i < options->numI2CBuses; i++){
+        struct GANG_WORKER* worker = &workers[i];
+        worker->options = options;
+        worker->gpioConfig = gpioConfig;
+        worker->eeprom = *eeprom;
+        worker->eeprom.i2cBus = options->i2cBuses[i];
+        worker->eeprom.byteWriteCounter = 0;
+        worker->eeprom.byteReadCounter = 0;
+        worker->isOpen = 0;
+        if(worker->eeprom.i2cBus != eeprom->i2cBus){
+            if((options->gpioBackend == SIM && connectEEPROMSim(&worker->eeprom)) || \
+                                                                    openI2CDevices(&worker->eeprom)){
+                error = -1;
+                break;
+            }
+            worker->isOpen = 1;
+        }
+        result->numBuses++;
+    }
+
+    // WP is shared by every bus and only driven from here
+    if(!error && !eeprom->isWriteProtectDisabled && options->action != COMPARE_FILE_TO_ROM){
+        writeGPIO(&gpioConfig->gpioChip, eeprom->writeProtectPin, LOW);
+        eeprom->isWriteProtectDisabled = 1;
+    }
+
+    numFinished = 0;
+    int numStarted = 0;
+    for(int i = 0; !error && i < result->numBuses; i++){
+        workers[i].eeprom.isWriteProtectDisabled = 1;
+        if(pthread_create(&workers[i].thread, NULL, runWorkerGang, &workers[i])){
+            ulog(ERROR,"Unable to start a thread for bus %i",workers[i].eeprom.i2cBus);
+            error = -1;
+            break;
+        }
+        numStarted++;
+    }
+    for(int i = 0; i < numStarted; i++){
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    for(int i = 0; i < result->numBuses; i++){
+        struct GANG_WORKER* worker = &workers[i];
+        if(worker->isOpen){
+            closeI2CDevices(&worker->eeprom);
+        }
+        result->buses[i] = worker->eeprom.i2cBus;
+        result->results[i] = i < numStarted ? worker->result : -1;
+        result->byteWriteCounters[i] = worker->eeprom.byteWriteCounter;
+        result->byteReadCounters[i] = worker->eeprom.byteReadCounter;
+        eeprom->byteWriteCounter += worker->eeprom.byteWriteCounter;
+        eeprom->byteReadCounter += worker->eeprom.byteReadCounter;
+        eeprom->delayedCycles += worker->eeprom.delayedCycles;
+        if(result->results[i] == -1){
+            ulog(ERROR,"Bus %i failed",result->buses[i]);
+            error = -1;
+        } else {
+            bytesNotMatched += result->results[i];
+        }
+    }
+    return error ? -1 : bytesNotMatched;
+}
+
+/* Prints a line for each bus */
+void printGangResult(struct GANG_RESULT* result, int action){
+    for(int i = 0; i < result->numBuses; i++){
+        if(result->results[i] == -1){
+            fprintf(stderr,"Bus %i: Failed\n", result->buses[i]);
+        } else if(action == COMPARE_FILE_TO_ROM){
+            fprintf(stdout,"Bus %i: %i bytes do not match\n", result->buses[i], result->results[i]);
+        } else {
+            fprintf(stdout,"Bus %i: Wrote %i bytes\n", result->buses[i], result->byteWriteCounters[i]);
+        }
+    }
+}
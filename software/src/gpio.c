@@ -1,8 +1,15 @@
+#include <errno.h>
 #include <fcntl.h>
-#include <gpiod.h>
+#include <stdio.h>
+#ifndef NO_GPIOD
+    #include <gpiod.h>
+#endif
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "gpio.h"
@@ -10,16 +17,41 @@
 #include "ulog.h"
 
 #define MAX_USABLE_GPIO_LINES 34
+#define MAX_GPIOMEM_LINES 32
 #define SDA1_PIN 2
 #define SCL1_PIN 3
 #define BLOCK_SIZE 4096
+#define EDGE_EVENT_BUFFER_SIZE 16
+#define LEVEL_POLL_USEC 20
+#define MAX_I2C_DEV_FDS 256
 
 enum ALT_MODE {ALT0=0,ALT1,ALT2,ALT3,ALT4,ALT5};
 
 // GPIO setup macros. Always use INP_GPIO(x) before using OUT_GPIO(x) or SET_GPIO_ALT(x,y)
 #define INP_GPIO(gpio,g) *(gpio+((g)/10)) &= ~(7<<(((g)%10)*3))
+#define OUT_GPIO(gpio,g) *(gpio+((g)/10)) |=  (1<<(((g)%10)*3))
 #define SET_GPIO_ALT(gpio,g,a) *(gpio+(((g)/10))) |= (((a)<=3?(a)+4:(a)==4?3:2)<<(((g)%10)*3))
 
+// GPIO register macros. Bits which are 1 are set or cleared, bits which are 0 are ignored
+#define GPIO_SET(gpio) *(gpio+7)
+#define GPIO_CLR(gpio) *(gpio+10)
+#define GPIO_LEV(gpio) *(gpio+13)
+
+/* Strings that correlate to GPIO_BACKEND enum so that the backend can be printed */
+const char* GPIO_BACKEND_STRINGS[] = {"libgpiod","gpiomem","sim"};
+
+/* Static global backend used by all GPIO chips */
+static int gpioBackend = LIBGPIOD;
+
+/* Backend operations that correlate to the GPIO_BACKEND enum. Defined below */
+static const struct GPIO_BACKEND_OPS* getBackendOps(int backend);
+
+/* I2C id and whether the adapter can do combined transactions of each open i2c-dev fd */
+static struct I2C_DEV{
+    unsigned short id;
+    int useCombined;
+} i2cDevs[MAX_I2C_DEV_FDS];
+
 /* Set the ALT MODE of the specified pin */
 void setPinAltModeGPIO(volatile unsigned int* gpio, int pin, enum ALT_MODE altMode){
     INP_GPIO(gpio,pin);
@@ -45,150 +77,83 @@ int checkConfigGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
     return rtnVal;
 }
 
-/* Sets up GPIO to be used */
-int setupGPIO(struct GPIO_CHIP* gpioChip){
-    int err = 0;
-    
-    if(gpioChip == NULL){
-        ulog(ERROR,"gpioChip cannot be NULL");
-        return -1;
-    }
-    if(gpioChip->chipname == NULL){
-        ulog(ERROR,"Chipname cannot be NULL");
-        return -1;
-    }
-    if(gpioChip->consumer == NULL){
-        ulog(ERROR,"Consumer cannot be NULL");
-        return -1;
-    }
-    if(gpioChip->isSetup){
-        ulog(ERROR,"GPIO is already setup");
-        return -1;
-    }
-    
-    gpioChip->chip = gpiod_chip_open_by_name(gpioChip->chipname);
-    if (gpioChip->chip == NULL){
-        ulog(ERROR,"Unable to get chip by name: %s",gpioChip->chipname);
-        return -1;
-    }
-    if(gpioChip->numGPIOLines > MAX_USABLE_GPIO_LINES && gpioChip->numGPIOLines < gpiod_chip_num_lines(gpioChip->chip)){
-        ulog(ERROR,"Invalid Line Count Requested for Chip. Max for Chip: %i",MAX_USABLE_GPIO_LINES);
+/* Ensure chip and bulk are valid */
+int checkBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    if(checkConfigGPIO(gpioChip, 0)){
         return -1;
     }
-    if(gpioChip->numGPIOLines >= gpiod_chip_num_lines(gpioChip->chip) || gpioChip->numGPIOLines < 0){
-        ulog(ERROR,"Invalid Number of Lines Requested for Chip. Max: %i",gpiod_chip_num_lines(gpioChip->chip));
+    if(bulk == NULL || !bulk->isRequested){
+        ulog(ERROR,"Bulk is not requested.");
         return -1;
     }
-
-    for(int i=0; i < gpioChip->numGPIOLines && err == 0; i++){
-        gpioChip->gpioLines[i] = gpiod_chip_get_line(gpioChip->chip, i);
-        if(gpioChip->gpioLines[i] == NULL){
-            ulog(ERROR,"Unable to get line: %i",i);
-            err = -1;
-        } else {
-            err = gpiod_line_request_output(gpioChip->gpioLines[i], gpioChip->consumer, 0);
-            if(err){
-                ulog(ERROR,"Error initially requesting line for OUTPUT");
-            }
-        }
-    }
-    if(err != -1){
-        gpioChip->isSetup = 1;
-        gpioChip->numLinesInUse = gpioChip->numGPIOLines;
-    }
-    
-    return err;
+    return 0;
 }
 
-/* Set the GPIO Pin mode to be INPUT or OUTPUT */
-int setPinModeGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int pinMode){
-    int err = 0;
-    
-    if(checkConfigGPIO(gpioChip,gpioLineNumber)){
-        return -1;
+/* Build the lookup tables between bulk levels and 32 bit GPIO registers */
+void buildBulkTablesGPIO(struct GPIO_BULK* bulk){
+    bulk->lineMask = 0;
+    for(int i = 0; i < bulk->numLines; i++){
+        if(bulk->lines[i] < 32){
+            bulk->lineMask |= 1u << bulk->lines[i];
+        }
     }
-
-    if(pinMode == OUTPUT){
-        // output
-        err = gpiod_line_set_config(gpioChip->gpioLines[gpioLineNumber],GPIOD_LINE_REQUEST_DIRECTION_OUTPUT,0,0);
-        if(err){
-            ulog(ERROR,"Error requesting OUTPUT");
+    for(int slice = 0; slice < BULK_LEVEL_SLICES; slice++){
+        for(int byte = 0; byte < 256; byte++){
+            unsigned int mask = 0;
+            for(int bit = 0; bit < 8 && slice*8+bit < bulk->numLines; bit++){
+                if(((byte >> bit) & 1) && bulk->lines[slice*8+bit] < 32){
+                    mask |= 1u << bulk->lines[slice*8+bit];
+                }
+            }
+            bulk->setMasks[slice][byte] = mask;
         }
-    } else if(pinMode == INPUT){
-        // input
-        err = gpiod_line_set_config(gpioChip->gpioLines[gpioLineNumber],GPIOD_LINE_REQUEST_DIRECTION_INPUT,0,0);
-        if(err){
-            ulog(ERROR,"Error requesting INPUT");
+    }
+    for(int slice = 0; slice < REGISTER_SLICES; slice++){
+        for(int byte = 0; byte < 256; byte++){
+            unsigned short levels = 0;
+            for(int i = 0; i < bulk->numLines; i++){
+                int line = bulk->lines[i] - slice*8;
+                if(line >= 0 && line < 8 && ((byte >> line) & 1)){
+                    levels |= 1u << i;
+                }
+            }
+            bulk->registerLevels[slice][byte] = levels;
         }
-    } else {
-        ulog(ERROR,"Invalid Pin Mode: %i",pinMode);
-        err = -1;
     }
-    return err;
 }
 
-/* Read from a specified GPIO Pin */
-int readGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
-    int val = 0;
- 
-    if(checkConfigGPIO(gpioChip,gpioLineNumber)){
-        return -1;
-    }
-
-    if((gpiod_line_direction(gpioChip->gpioLines[gpioLineNumber]) == GPIOD_LINE_DIRECTION_INPUT)){
-        val = gpiod_line_get_value(gpioChip->gpioLines[gpioLineNumber]);
-        if( val == -1){
-            ulog(ERROR,"Failed to read input on Pin %i",gpioLineNumber);
-        }
-    } else {
-        val = -1;
-        ulog(ERROR,"Pin: %i not configured as INPUT. Cannot be read.",gpioLineNumber);
-    }
-    return val;
+/* Get the GPIO register bits that are set for the levels of a bulk */
+unsigned int getBulkSetMask(struct GPIO_BULK* bulk, unsigned int levels){
+    return bulk->setMasks[0][levels & 0xFF] | bulk->setMasks[1][(levels >> 8) & 0xFF];
 }
 
-/* Write a level to a specified GPIO Pin */
-int writeGPIO(struct GPIO_CHIP* gpioChip,int gpioLineNumber,int level){
-    int err = 0;
+/* Get the levels of a bulk from a GPIO level register */
+unsigned int getBulkRegisterLevels(struct GPIO_BULK* bulk, unsigned int reg){
+    return bulk->registerLevels[0][reg & 0xFF] | bulk->registerLevels[1][(reg >> 8) & 0xFF] | \
+            bulk->registerLevels[2][(reg >> 16) & 0xFF] | bulk->registerLevels[3][reg >> 24];
+}
 
-    if(checkConfigGPIO(gpioChip,gpioLineNumber)){
-        return -1;
-    }
-    if(level != 0 && level != 1){
-        ulog(ERROR,"Invalid level %i for line: %i", level,gpioLineNumber);
+/* Sets the GPIO backend used by setupGPIO */
+int setBackendGPIO(int backend){
+    if(backend >= 0 && backend < END_GPIO_BACKEND && getBackendOps(backend) == NULL){
+        ulog(ERROR,"GPIO backend %s is not available in this build",GPIO_BACKEND_STRINGS[backend]);
         return -1;
     }
-
-    if((gpiod_line_direction(gpioChip->gpioLines[gpioLineNumber]) == GPIOD_LINE_DIRECTION_OUTPUT)){
-        err = gpiod_line_set_value(gpioChip->gpioLines[gpioLineNumber],level);
-        if(err){
-            ulog(ERROR,"Cound not set level: %i on line number: %i",level,gpioLineNumber);
-        }
+    if(backend >= 0 && backend < END_GPIO_BACKEND){
+        gpioBackend = backend;
+        ulog(INFO,"Setting GPIO backend to %s",GPIO_BACKEND_STRINGS[backend]);
+        return 0;
     } else {
-        err = -1;
-        ulog(ERROR,"Pin: %i not configured as OUTPUT. Cannot be written.",gpioLineNumber);
+        ulog(ERROR,"Invalid GPIO backend: %i",backend);
+        return -1;
     }
-    return err;
 }
 
-/* Release the chip and GPIO lines */
-void cleanupGPIO(struct GPIO_CHIP* gpioChip){
-    if(gpioChip->isSetup){
-        gpioChip->isSetup = 0;
-        // Releasing the gpioLines may not be needed since I think it's handled by
-        // gpiod_chip_close
-        for(int i=0; i < gpioChip->numLinesInUse; i++){
-            gpiod_line_release(gpioChip->gpioLines[i]);
-        }
-        gpiod_chip_close(gpioChip->chip);
-    }
-    
+/* Returns the currently set GPIO backend */
+int getBackendGPIO(){
+    return gpioBackend;
 }
 
-/*****************************************************************************/
-/*****************************************************************************/
-/*****************************************************************************/
-
 /* Map memory used by GPIO */
 volatile unsigned int* mapGPIOMemory(){
     int  mem_fd;
@@ -219,37 +184,61 @@ volatile unsigned int* mapGPIOMemory(){
     return (volatile unsigned int*)gpio_map;
 }
 
-/* Sets up an I2C device to be used via the built in I2C pins */
-int setupI2C(char I2CId){
-    // Always use volatile pointer!
-    volatile unsigned int* gpio = mapGPIOMemory();
-    if(gpio == (volatile unsigned int*)-1){
-        return -1;
+/*****************************************************************************/
+/******************************** i2c-dev ************************************/
+/*****************************************************************************/
+
+/* Sets up an I2C device on /dev/i2c-N. Bus 1 uses the built in I2C pins */
+int setupI2CDev(int bus, char I2CId){
+    char devicePath[32];
+
+    if(bus == DEFAULT_I2C_BUS){
+        // Always use volatile pointer!
+        volatile unsigned int* gpio = mapGPIOMemory();
+        if(gpio == (volatile unsigned int*)-1){
+            return -1;
+        }
+
+        setPinAltModeGPIO(gpio, SDA1_PIN, ALT0);
+        setPinAltModeGPIO(gpio, SCL1_PIN, ALT0);
+        // The pins keep their mode so the registers are not needed once it is set
+        munmap((void*)gpio, BLOCK_SIZE);
     }
-    
-    setPinAltModeGPIO(gpio, SDA1_PIN, ALT0);
-    setPinAltModeGPIO(gpio, SCL1_PIN, ALT0);
-    
-    ulog(INFO,"Setting up I2C Device with ID: 0x%02x",I2CId);
-    int fd = open("/dev/i2c-1", O_RDWR );
+
+    ulog(INFO,"Setting up I2C Device with ID: 0x%02x on bus %i",I2CId,bus);
+    snprintf(devicePath, sizeof(devicePath), "/dev/i2c-%i", bus);
+    int fd = open(devicePath, O_RDWR );
     if(fd == -1){
         ulog(ERROR,"Error opening device.");
         return -1;
     }
     if(ioctl(fd, I2C_SLAVE, I2CId) == -1){
          ulog(ERROR,"Error configuring device.");
+         close(fd);
          return -1;
     }
     // Dummy write to make sure device is setup
     if(write(fd, NULL, 0) != 0){
         ulog(ERROR,"Device not available");
+        close(fd);
         return -1;
     }
+
+    // Reads are a combined write and read with a repeated start when the adapter
+    // supports plain I2C messages and a write and a separate read otherwise
+    unsigned long funcs = 0;
+    if(fd < MAX_I2C_DEV_FDS){
+        i2cDevs[fd].id = I2CId;
+        i2cDevs[fd].useCombined = ioctl(fd, I2C_FUNCS, &funcs) != -1 && (funcs & I2C_FUNC_I2C);
+        if(!i2cDevs[fd].useCombined){
+            ulog(INFO,"I2C adapter does not support combined transactions");
+        }
+    }
     return fd;
 }
 
-/* Read from a specified address via I2C */
-int readI2C(int fd, char* buf, int numBytesToRead, int addressSize){
+/* Read from a specified address via /dev/i2c-N with a write and a separate read */
+int readI2CDevSplit(int fd, char* buf, int numBytesToRead, int addressSize){
     int bytesWritten = write(fd, buf, addressSize);
     if(bytesWritten == -1){
         ulog(ERROR,"Error reading byte(s) via I2C");
@@ -264,17 +253,1162 @@ int readI2C(int fd, char* buf, int numBytesToRead, int addressSize){
     return bytesRead;
 }
 
-/* Write page to a specified address via I2C */
-int writeI2C(int fd, char* data, int numBytesToWrite){
-    // Write the byte[s]
-    int bytesWritten = write(fd, data, numBytesToWrite);
-    if(bytesWritten == -1 && data != NULL && numBytesToWrite != 0){
+/* Read from a specified address via /dev/i2c-N. The address is written and the
+   bytes are read back in one I2C_RDWR transaction with a repeated start. Adapters
+   that turn the transaction down fall back to a write and a separate read */
+int readI2CDev(int fd, char* buf, int numBytesToRead, int addressSize){
+    if(numBytesToRead > MAX_I2C_READ_LEN){
+        ulog(ERROR,"Cannot read more than %i bytes in one I2C transaction", MAX_I2C_READ_LEN);
+        return -1;
+    }
+    if(fd < 0 || fd >= MAX_I2C_DEV_FDS || !i2cDevs[fd].useCombined){
+        return readI2CDevSplit(fd, buf, numBytesToRead, addressSize);
+    }
+
+    char address[addressSize];
+    // The address is copied out since buf is also the destination of the read
+    for(int i = 0; i < addressSize; i++){
+        address[i] = buf[i];
+    }
+    struct i2c_msg msgs[2] = {
+        {i2cDevs[fd].id, 0, addressSize, (unsigned char*)address},
+        {i2cDevs[fd].id, I2C_M_RD, numBytesToRead, (unsigned char*)buf}
+    };
+    struct i2c_rdwr_ioctl_data transaction = {msgs, 2};
+    if(ioctl(fd, I2C_RDWR, &transaction) != 2){
+        if(errno == EOPNOTSUPP){
+            ulog(INFO,"I2C adapter does not support combined transactions");
+            i2cDevs[fd].useCombined = 0;
+            for(int i = 0; i < addressSize; i++){
+                buf[i] = address[i];
+            }
+            return readI2CDevSplit(fd, buf, numBytesToRead, addressSize);
+        }
+        ulog(ERROR,"Error reading byte(s) via I2C");
+        return -1;
+    }
+    return numBytesToRead;
+}
+
+/* Write page to a specified address via /dev/i2c-N. An empty write is an
+   acknowledge poll sent as a zero length I2C_RDWR message. A device that does not
+   acknowledge is busy and not an error */
+int writeI2CDev(int fd, char* data, int numBytesToWrite){
+    int bytesWritten;
+    if((data == NULL || numBytesToWrite == 0) && fd >= 0 && fd < MAX_I2C_DEV_FDS && i2cDevs[fd].useCombined){
+        struct i2c_msg msg = {i2cDevs[fd].id, 0, 0, NULL};
+        struct i2c_rdwr_ioctl_data transaction = {&msg, 1};
+        bytesWritten = ioctl(fd, I2C_RDWR, &transaction) == 1 ? 0 : -1;
+    } else {
+        // Write the byte[s]
+        bytesWritten = write(fd, data, numBytesToWrite);
+    }
+    if(bytesWritten == -1 && data != NULL && numBytesToWrite != 0 && errno != ENXIO && errno != EREMOTEIO){
         ulog(ERROR,"Error writing byte(s) via I2C");
     }
     return bytesWritten;
 }
 
-/* Closes a specified I2C device */
-void cleanupI2C(int fd){
+/* Closes a specified /dev/i2c-N device */
+void cleanupI2CDev(int fd){
+    if(fd >= 0 && fd < MAX_I2C_DEV_FDS){
+        i2cDevs[fd].useCombined = 0;
+    }
     close(fd);
 }
+
+/*****************************************************************************/
+/******************************* libgpiod ************************************/
+/*****************************************************************************/
+#ifndef NO_GPIOD
+#ifdef GPIOD_V2
+
+/* Build a libgpiod v2 line config that sets a group of lines to INPUT or OUTPUT */
+struct gpiod_line_config* buildLineConfigLibgpiod(unsigned int* offsets, int numLines, int direction){
+    struct gpiod_line_settings* settings = gpiod_line_settings_new();
+    struct gpiod_line_config* lineConfig = gpiod_line_config_new();
+
+    if(settings == NULL || lineConfig == NULL || \
+        gpiod_line_settings_set_direction(settings, direction == OUTPUT ? GPIOD_LINE_DIRECTION_OUTPUT : \
+                                                                            GPIOD_LINE_DIRECTION_INPUT) || \
+        gpiod_line_config_add_line_settings(lineConfig, offsets, numLines, settings)){
+        gpiod_line_config_free(lineConfig);
+        lineConfig = NULL;
+    }
+    gpiod_line_settings_free(settings);
+    return lineConfig;
+}
+
+/* Set the levels that an OUTPUT line config drives once it is applied */
+int setOutputValuesLibgpiod(struct gpiod_line_config* lineConfig, int* values, int numLines){
+    enum gpiod_line_value lineValues[MAX_BULK_LINES];
+    for(int i = 0; i < numLines; i++){
+        lineValues[i] = values[i] ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+    }
+    return gpiod_line_config_set_output_values(lineConfig, lineValues, numLines);
+}
+
+/* Release a libgpiod v2 request and free its line configs */
+void releaseLinesLibgpiod(struct gpiod_line_request** request, struct gpiod_line_config** lineConfigs){
+    if(*request != NULL){
+        gpiod_line_request_release(*request);
+        *request = NULL;
+    }
+    for(int direction = INPUT; direction <= OUTPUT; direction++){
+        gpiod_line_config_free(lineConfigs[direction]);
+        lineConfigs[direction] = NULL;
+    }
+}
+
+/* Request a group of lines as one libgpiod v2 request. The INPUT and OUTPUT
+   line configs are built once here and reused whenever the direction changes */
+struct gpiod_line_request* requestLinesLibgpiod(struct GPIO_CHIP* gpioChip, unsigned int* offsets, int* values, \
+                                        int numLines, int direction, struct gpiod_line_config** lineConfigs){
+    struct gpiod_request_config* requestConfig = gpiod_request_config_new();
+    struct gpiod_line_request* request = NULL;
+
+    lineConfigs[INPUT] = buildLineConfigLibgpiod(offsets, numLines, INPUT);
+    lineConfigs[OUTPUT] = buildLineConfigLibgpiod(offsets, numLines, OUTPUT);
+    if(requestConfig != NULL && lineConfigs[INPUT] != NULL && lineConfigs[OUTPUT] != NULL && \
+                                                !setOutputValuesLibgpiod(lineConfigs[OUTPUT], values, numLines)){
+        gpiod_request_config_set_consumer(requestConfig, gpioChip->consumer);
+        request = gpiod_chip_request_lines(gpioChip->chip, requestConfig, lineConfigs[direction]);
+    }
+    gpiod_request_config_free(requestConfig);
+    if(request == NULL){
+        releaseLinesLibgpiod(&request, lineConfigs);
+    }
+    return request;
+}
+
+/* Request a single line as OUTPUT at the given level with libgpiod v2 */
+int requestLineLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level){
+    unsigned int offset = gpioLineNumber;
+    gpioChip->lineRequests[gpioLineNumber] = requestLinesLibgpiod(gpioChip, &offset, &level, 1, OUTPUT, \
+                                                                        gpioChip->lineConfigs[gpioLineNumber]);
+    if(gpioChip->lineRequests[gpioLineNumber] == NULL){
+        ulog(ERROR,"Error requesting line: %i for OUTPUT",gpioLineNumber);
+        return -1;
+    }
+    return 0;
+}
+
+/* Sets up GPIO lines with libgpiod v2 */
+int setupLibgpiod(struct GPIO_CHIP* gpioChip){
+    struct gpiod_chip_info* chipInfo = NULL;
+    char chipPath[64];
+    int numChipLines = 0;
+    int err = 0;
+
+    snprintf(chipPath, sizeof(chipPath), "/dev/%s", gpioChip->chipname);
+    gpioChip->chip = gpiod_chip_open(chipPath);
+    if (gpioChip->chip == NULL){
+        ulog(ERROR,"Unable to open chip: %s",chipPath);
+        return -1;
+    }
+    chipInfo = gpiod_chip_get_info(gpioChip->chip);
+    if (chipInfo == NULL){
+        ulog(ERROR,"Unable to get info for chip: %s",gpioChip->chipname);
+        return -1;
+    }
+    numChipLines = gpiod_chip_info_get_num_lines(chipInfo);
+    gpiod_chip_info_free(chipInfo);
+    gpioChip->edgeEventBuffer = NULL;
+    if(gpioChip->numGPIOLines > MAX_USABLE_GPIO_LINES && gpioChip->numGPIOLines < numChipLines){
+        ulog(ERROR,"Invalid Line Count Requested for Chip. Max for Chip: %i",MAX_USABLE_GPIO_LINES);
+        return -1;
+    }
+    if(gpioChip->numGPIOLines >= numChipLines || gpioChip->numGPIOLines < 0){
+        ulog(ERROR,"Invalid Number of Lines Requested for Chip. Max: %i",numChipLines);
+        return -1;
+    }
+
+    for(int i=0; i < gpioChip->numGPIOLines && err == 0; i++){
+        gpioChip->lineBulk[i] = NULL;
+        err = requestLineLibgpiod(gpioChip, i, LOW);
+    }
+    return err;
+}
+
+/* Set the GPIO Pin mode with libgpiod v2 by applying a prebuilt line config */
+int setPinModeLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int pinMode){
+    struct gpiod_line_config** lineConfigs = gpioChip->lineConfigs[gpioLineNumber];
+    int err = 0;
+
+    if(pinMode == OUTPUT){
+        // output at the last level written to the line
+        err = setOutputValuesLibgpiod(lineConfigs[OUTPUT], &gpioChip->lineLevels[gpioLineNumber], 1);
+    }
+    if(!err){
+        err = gpiod_line_request_reconfigure_lines(gpioChip->lineRequests[gpioLineNumber], lineConfigs[pinMode]);
+    }
+    if(err){
+        ulog(ERROR,"Error requesting %s",pinMode == OUTPUT ? "OUTPUT" : "INPUT");
+    }
+    return err;
+}
+
+/* Read from a GPIO Pin with libgpiod v2 */
+int readLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    int val = gpiod_line_request_get_value(gpioChip->lineRequests[gpioLineNumber], gpioLineNumber);
+    if( val == GPIOD_LINE_VALUE_ERROR){
+        ulog(ERROR,"Failed to read input on Pin %i",gpioLineNumber);
+        return -1;
+    }
+    return val;
+}
+
+/* Write a level to a GPIO Pin with libgpiod v2 */
+int writeLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level){
+    int err = gpiod_line_request_set_value(gpioChip->lineRequests[gpioLineNumber], gpioLineNumber, \
+                                            level ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE);
+    if(err){
+        ulog(ERROR,"Cound not set level: %i on line number: %i",level,gpioLineNumber);
+    }
+    return err;
+}
+
+/* Request a group of GPIO lines as one request with libgpiod v2 */
+int requestBulkLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    unsigned int offsets[MAX_BULK_LINES];
+
+    // Lines have to be released so that they can be requested as one request
+    for(int i = 0; i < bulk->numLines; i++){
+        offsets[i] = bulk->lines[i];
+        releaseLinesLibgpiod(&gpioChip->lineRequests[bulk->lines[i]], gpioChip->lineConfigs[bulk->lines[i]]);
+    }
+
+    bulk->request = requestLinesLibgpiod(gpioChip, offsets, bulk->values, bulk->numLines, bulk->direction, \
+                                                                                            bulk->lineConfigs);
+    if(bulk->request == NULL){
+        for(int i = 0; i < bulk->numLines; i++){
+            requestLineLibgpiod(gpioChip, bulk->lines[i], LOW);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/* Set every line of a bulk to be INPUT or OUTPUT with one reconfigure with libgpiod v2 */
+int setBulkModeLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int direction){
+    int err = 0;
+
+    if(direction == OUTPUT){
+        err = setOutputValuesLibgpiod(bulk->lineConfigs[OUTPUT], bulk->values, bulk->numLines);
+    }
+    if(!err){
+        err = gpiod_line_request_reconfigure_lines(bulk->request, bulk->lineConfigs[direction]);
+    }
+    if(err){
+        ulog(ERROR,"Error requesting %s for bulk",direction == OUTPUT ? "OUTPUT" : "INPUT");
+    }
+    return err;
+}
+
+/* Read every line of a bulk with libgpiod v2 */
+int readBulkLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    enum gpiod_line_value values[MAX_BULK_LINES];
+    int levels = 0;
+
+    if(gpiod_line_request_get_values(bulk->request, values)){
+        ulog(ERROR,"Failed to read input on bulk");
+        return -1;
+    }
+    for(int i = bulk->numLines-1; i >= 0; i--){
+        levels = (levels << 1) | (values[i] == GPIOD_LINE_VALUE_ACTIVE);
+    }
+    return levels;
+}
+
+/* Write the cached values of a bulk with libgpiod v2 */
+int writeBulkLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    enum gpiod_line_value values[MAX_BULK_LINES];
+    int err = 0;
+
+    for(int i = 0; i < bulk->numLines; i++){
+        values[i] = bulk->values[i] ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+    }
+    err = gpiod_line_request_set_values(bulk->request, values);
+    if(err){
+        ulog(ERROR,"Cound not set levels: 0x%04x on bulk",bulk->levels);
+    }
+    return err;
+}
+
+/* Release a bulk and request its lines individually again with libgpiod v2 */
+void releaseBulkLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    releaseLinesLibgpiod(&bulk->request, bulk->lineConfigs);
+    for(int i = 0; i < bulk->numLines; i++){
+        requestLineLibgpiod(gpioChip, bulk->lines[i], bulk->values[i]);
+    }
+}
+
+/* Write several bulks one request at a time with libgpiod v2 */
+int writeBulksLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, int numBulks){
+    int err = 0;
+    for(int j = 0; j < numBulks && !err; j++){
+        err = writeBulkLibgpiod(gpioChip, bulks[j]);
+    }
+    return err;
+}
+
+/* Reconfigure the request of an INPUT line to detect both edges with libgpiod v2 */
+int requestEventsLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    struct gpiod_line_settings* settings = gpiod_line_settings_new();
+    struct gpiod_line_config* lineConfig = gpiod_line_config_new();
+    unsigned int offset = gpioLineNumber;
+    int err = -1;
+
+    if(gpioChip->edgeEventBuffer == NULL){
+        gpioChip->edgeEventBuffer = gpiod_edge_event_buffer_new(EDGE_EVENT_BUFFER_SIZE);
+    }
+    if(settings != NULL && lineConfig != NULL && gpioChip->edgeEventBuffer != NULL){
+        gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+        gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+        err = gpiod_line_config_add_line_settings(lineConfig, &offset, 1, settings);
+        if(!err){
+            err = gpiod_line_request_reconfigure_lines(gpioChip->lineRequests[gpioLineNumber], lineConfig);
+        }
+    }
+    gpiod_line_config_free(lineConfig);
+    gpiod_line_settings_free(settings);
+    if(err){
+        ulog(ERROR,"Error requesting edge events on line: %i",gpioLineNumber);
+    }
+    return err;
+}
+
+/* Sleep on the request's file descriptor until an edge or the timeout with libgpiod v2 */
+int waitEventLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int timeoutMSec){
+    struct gpiod_line_request* request = gpioChip->lineRequests[gpioLineNumber];
+    int ret = gpiod_line_request_wait_edge_events(request, timeoutMSec * 1000000LL);
+    if(ret == 1){
+        // Only the level matters so the events are drained rather than inspected
+        ret = gpiod_line_request_read_edge_events(request, gpioChip->edgeEventBuffer, EDGE_EVENT_BUFFER_SIZE);
+        ret = ret < 0 ? -1 : 1;
+    }
+    if(ret == -1){
+        ulog(ERROR,"Error waiting for edge events on line: %i",gpioLineNumber);
+    }
+    return ret;
+}
+
+/* Return a line to a plain INPUT with libgpiod v2 */
+void releaseEventsLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    gpiod_line_request_reconfigure_lines(gpioChip->lineRequests[gpioLineNumber], \
+                                                            gpioChip->lineConfigs[gpioLineNumber][INPUT]);
+}
+
+/* Release the requests and close the chip with libgpiod v2. Unlike v1 the
+   requests are not owned by the chip so every one has to be released */
+void cleanupLibgpiod(struct GPIO_CHIP* gpioChip){
+    if(gpioChip->edgeEventBuffer != NULL){
+        gpiod_edge_event_buffer_free(gpioChip->edgeEventBuffer);
+        gpioChip->edgeEventBuffer = NULL;
+    }
+    for(int i=0; i < gpioChip->numLinesInUse; i++){
+        if(gpioChip->lineBulk[i] != NULL){
+            releaseLinesLibgpiod(&gpioChip->lineBulk[i]->request, gpioChip->lineBulk[i]->lineConfigs);
+        } else {
+            releaseLinesLibgpiod(&gpioChip->lineRequests[i], gpioChip->lineConfigs[i]);
+        }
+    }
+    gpiod_chip_close(gpioChip->chip);
+}
+#else
+
+/* Sets up GPIO lines with libgpiod */
+int setupLibgpiod(struct GPIO_CHIP* gpioChip){
+    int err = 0;
+
+    gpioChip->chip = gpiod_chip_open_by_name(gpioChip->chipname);
+    if (gpioChip->chip == NULL){
+        ulog(ERROR,"Unable to get chip by name: %s",gpioChip->chipname);
+        return -1;
+    }
+    if(gpioChip->numGPIOLines > MAX_USABLE_GPIO_LINES && gpioChip->numGPIOLines < gpiod_chip_num_lines(gpioChip->chip)){
+        ulog(ERROR,"Invalid Line Count Requested for Chip. Max for Chip: %i",MAX_USABLE_GPIO_LINES);
+        return -1;
+    }
+    if(gpioChip->numGPIOLines >= gpiod_chip_num_lines(gpioChip->chip) || gpioChip->numGPIOLines < 0){
+        ulog(ERROR,"Invalid Number of Lines Requested for Chip. Max: %i",gpiod_chip_num_lines(gpioChip->chip));
+        return -1;
+    }
+
+    for(int i=0; i < gpioChip->numGPIOLines && err == 0; i++){
+        gpioChip->lineBulk[i] = NULL;
+        gpioChip->gpioLines[i] = gpiod_chip_get_line(gpioChip->chip, i);
+        if(gpioChip->gpioLines[i] == NULL){
+            ulog(ERROR,"Unable to get line: %i",i);
+            err = -1;
+        } else {
+            err = gpiod_line_request_output(gpioChip->gpioLines[i], gpioChip->consumer, 0);
+            if(err){
+                ulog(ERROR,"Error initially requesting line for OUTPUT");
+            }
+        }
+    }
+    return err;
+}
+
+/* Set the GPIO Pin mode with libgpiod */
+int setPinModeLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int pinMode){
+    int err = 0;
+
+    if(pinMode == OUTPUT){
+        // output at the last level written to the line
+        err = gpiod_line_set_config(gpioChip->gpioLines[gpioLineNumber],GPIOD_LINE_REQUEST_DIRECTION_OUTPUT,0, \
+                                                                            gpioChip->lineLevels[gpioLineNumber]);
+        if(err){
+            ulog(ERROR,"Error requesting OUTPUT");
+        }
+    } else {
+        // input
+        err = gpiod_line_set_config(gpioChip->gpioLines[gpioLineNumber],GPIOD_LINE_REQUEST_DIRECTION_INPUT,0,0);
+        if(err){
+            ulog(ERROR,"Error requesting INPUT");
+        }
+    }
+    return err;
+}
+
+/* Read from a GPIO Pin with libgpiod */
+int readLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    int val = gpiod_line_get_value(gpioChip->gpioLines[gpioLineNumber]);
+    if( val == -1){
+        ulog(ERROR,"Failed to read input on Pin %i",gpioLineNumber);
+    }
+    return val;
+}
+
+/* Write a level to a GPIO Pin with libgpiod */
+int writeLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level){
+    int err = gpiod_line_set_value(gpioChip->gpioLines[gpioLineNumber],level);
+    if(err){
+        ulog(ERROR,"Cound not set level: %i on line number: %i",level,gpioLineNumber);
+    }
+    return err;
+}
+
+/* Fill a gpiod_line_bulk with the lines of a GPIO_BULK */
+void fillLineBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, struct gpiod_line_bulk* lineBulk){
+    gpiod_line_bulk_init(lineBulk);
+    for(int i = 0; i < bulk->numLines; i++){
+        gpiod_line_bulk_add(lineBulk, gpioChip->gpioLines[bulk->lines[i]]);
+    }
+}
+
+/* Request a group of GPIO lines as one handle with libgpiod */
+int requestBulkLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    struct gpiod_line_bulk lineBulk;
+    int err = 0;
+
+    // Lines have to be released so that they can be requested as one handle
+    for(int i = 0; i < bulk->numLines; i++){
+        gpiod_line_release(gpioChip->gpioLines[bulk->lines[i]]);
+    }
+
+    fillLineBulkGPIO(gpioChip, bulk, &lineBulk);
+    if(bulk->direction == OUTPUT){
+        err = gpiod_line_request_bulk_output(&lineBulk, gpioChip->consumer, bulk->values);
+    } else {
+        err = gpiod_line_request_bulk_input(&lineBulk, gpioChip->consumer);
+    }
+    if(err){
+        for(int i = 0; i < bulk->numLines; i++){
+            gpiod_line_request_output(gpioChip->gpioLines[bulk->lines[i]], gpioChip->consumer, 0);
+        }
+    }
+    return err;
+}
+
+/* Set every line of a bulk to be INPUT or OUTPUT with libgpiod */
+int setBulkModeLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int direction){
+    struct gpiod_line_bulk lineBulk;
+    int err = 0;
+
+    fillLineBulkGPIO(gpioChip, bulk, &lineBulk);
+    if(direction == OUTPUT){
+        err = gpiod_line_set_config_bulk(&lineBulk, GPIOD_LINE_REQUEST_DIRECTION_OUTPUT, 0, bulk->values);
+        if(err){
+            ulog(ERROR,"Error requesting OUTPUT for bulk");
+        }
+    } else {
+        err = gpiod_line_set_config_bulk(&lineBulk, GPIOD_LINE_REQUEST_DIRECTION_INPUT, 0, NULL);
+        if(err){
+            ulog(ERROR,"Error requesting INPUT for bulk");
+        }
+    }
+    return err;
+}
+
+/* Read every line of a bulk with libgpiod */
+int readBulkLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    struct gpiod_line_bulk lineBulk;
+    int values[MAX_BULK_LINES];
+    int levels = 0;
+
+    fillLineBulkGPIO(gpioChip, bulk, &lineBulk);
+    if(gpiod_line_get_value_bulk(&lineBulk, values)){
+        ulog(ERROR,"Failed to read input on bulk");
+        return -1;
+    }
+    for(int i = bulk->numLines-1; i >= 0; i--){
+        levels = (levels << 1) | (values[i] & 1);
+    }
+    return levels;
+}
+
+/* Write the cached values of a bulk with libgpiod */
+int writeBulkLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    struct gpiod_line_bulk lineBulk;
+    int err = 0;
+
+    fillLineBulkGPIO(gpioChip, bulk, &lineBulk);
+    err = gpiod_line_set_value_bulk(&lineBulk, bulk->values);
+    if(err){
+        ulog(ERROR,"Cound not set levels: 0x%04x on bulk",bulk->levels);
+    }
+    return err;
+}
+
+/* Release a bulk and request its lines individually again with libgpiod */
+void releaseBulkLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    for(int i = 0; i < bulk->numLines; i++){
+        gpiod_line_release(gpioChip->gpioLines[bulk->lines[i]]);
+    }
+    for(int i = 0; i < bulk->numLines; i++){
+        if(gpiod_line_request_output(gpioChip->gpioLines[bulk->lines[i]], gpioChip->consumer, bulk->values[i])){
+            ulog(ERROR,"Error requesting line for OUTPUT");
+        }
+    }
+}
+
+/* Write several bulks one handle at a time with libgpiod */
+int writeBulksLibgpiod(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, int numBulks){
+    int err = 0;
+    for(int j = 0; j < numBulks && !err; j++){
+        err = writeBulkLibgpiod(gpioChip, bulks[j]);
+    }
+    return err;
+}
+
+/* Request a line for edge events with libgpiod. Lines have to be released to change the request type */
+int requestEventsLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    gpiod_line_release(gpioChip->gpioLines[gpioLineNumber]);
+    if(gpiod_line_request_both_edges_events(gpioChip->gpioLines[gpioLineNumber], gpioChip->consumer)){
+        ulog(ERROR,"Error requesting edge events on line: %i",gpioLineNumber);
+        gpiod_line_request_input(gpioChip->gpioLines[gpioLineNumber], gpioChip->consumer);
+        return -1;
+    }
+    return 0;
+}
+
+/* Sleep on the line's file descriptor until an edge or the timeout with libgpiod */
+int waitEventLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int timeoutMSec){
+    struct pollfd pollFD = {.fd = gpiod_line_event_get_fd(gpioChip->gpioLines[gpioLineNumber]), .events = POLLIN};
+    struct gpiod_line_event event;
+
+    int ret = poll(&pollFD, 1, timeoutMSec);
+    if(ret == 1){
+        // Only the level matters so the event is drained rather than inspected
+        ret = gpiod_line_event_read_fd(pollFD.fd, &event) ? -1 : 1;
+    }
+    if(ret == -1){
+        ulog(ERROR,"Error waiting for edge events on line: %i",gpioLineNumber);
+    }
+    return ret;
+}
+
+/* Return a line to a plain INPUT with libgpiod */
+void releaseEventsLibgpiod(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    gpiod_line_release(gpioChip->gpioLines[gpioLineNumber]);
+    gpiod_line_request_input(gpioChip->gpioLines[gpioLineNumber], gpioChip->consumer);
+}
+
+/* Release the chip and GPIO lines with libgpiod */
+void cleanupLibgpiod(struct GPIO_CHIP* gpioChip){
+    // Releasing the gpioLines may not be needed since I think it's handled by
+    // gpiod_chip_close
+    for(int i=0; i < gpioChip->numLinesInUse; i++){
+        gpiod_line_release(gpioChip->gpioLines[i]);
+    }
+    gpiod_chip_close(gpioChip->chip);
+}
+#endif
+#endif
+
+/*****************************************************************************/
+/******************************** gpiomem ************************************/
+/*****************************************************************************/
+
+/* Sets up GPIO lines by mapping the GPIO registers */
+int setupGPIOMem(struct GPIO_CHIP* gpioChip){
+    if(gpioChip->numGPIOLines > MAX_GPIOMEM_LINES || gpioChip->numGPIOLines < 0){
+        ulog(ERROR,"Invalid Number of Lines Requested for gpiomem. Max: %i",MAX_GPIOMEM_LINES);
+        return -1;
+    }
+
+    gpioChip->gpioMem = mapGPIOMemory();
+    if(gpioChip->gpioMem == (volatile unsigned int*)-1){
+        return -1;
+    }
+
+    // Match libgpiod by starting every line as a LOW OUTPUT
+    for(int i=0; i < gpioChip->numGPIOLines; i++){
+        gpioChip->lineBulk[i] = NULL;
+        GPIO_CLR(gpioChip->gpioMem) = 1u << i;
+        INP_GPIO(gpioChip->gpioMem, i);
+        OUT_GPIO(gpioChip->gpioMem, i);
+    }
+    return 0;
+}
+
+/* Set the GPIO Pin mode through GPFSEL */
+int setPinModeGPIOMem(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int pinMode){
+    INP_GPIO(gpioChip->gpioMem, gpioLineNumber);
+    if(pinMode == OUTPUT){
+        OUT_GPIO(gpioChip->gpioMem, gpioLineNumber);
+    }
+    return 0;
+}
+
+/* Read from a GPIO Pin through GPLEV0 */
+int readGPIOMem(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    return (GPIO_LEV(gpioChip->gpioMem) >> gpioLineNumber) & 1;
+}
+
+/* Write a level to a GPIO Pin through GPSET0 or GPCLR0 */
+int writeGPIOMem(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level){
+    if(level){
+        GPIO_SET(gpioChip->gpioMem) = 1u << gpioLineNumber;
+    } else {
+        GPIO_CLR(gpioChip->gpioMem) = 1u << gpioLineNumber;
+    }
+    return 0;
+}
+
+/* Set every line of a bulk to be INPUT or OUTPUT through GPFSEL */
+int setBulkModeGPIOMem(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int direction){
+    if(direction == OUTPUT){
+        // Preload the output latches so the lines come up at their last levels
+        unsigned int setMask = getBulkSetMask(bulk, bulk->levels);
+        GPIO_SET(gpioChip->gpioMem) = setMask;
+        GPIO_CLR(gpioChip->gpioMem) = bulk->lineMask & ~setMask;
+    }
+    for(int i = 0; i < bulk->numLines; i++){
+        setPinModeGPIOMem(gpioChip, bulk->lines[i], direction);
+    }
+    return 0;
+}
+
+/* Read every line of a bulk with one load of GPLEV0 */
+int readBulkGPIOMem(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    return getBulkRegisterLevels(bulk, GPIO_LEV(gpioChip->gpioMem));
+}
+
+/* Write several bulks with one GPSET0 and GPCLR0 store */
+int writeBulksGPIOMem(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, int numBulks){
+    unsigned int setMask = 0;
+    unsigned int clrMask = 0;
+    for(int j = 0; j < numBulks; j++){
+        unsigned int bulkSetMask = getBulkSetMask(bulks[j], bulks[j]->levels);
+        setMask |= bulkSetMask;
+        clrMask |= bulks[j]->lineMask & ~bulkSetMask;
+    }
+    GPIO_SET(gpioChip->gpioMem) = setMask;
+    GPIO_CLR(gpioChip->gpioMem) = clrMask;
+    return 0;
+}
+
+/* Request a group of GPIO lines through GPFSEL. No handle is needed */
+int requestBulkGPIOMem(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    return setBulkModeGPIOMem(gpioChip, bulk, bulk->direction);
+}
+
+/* Return the lines of a bulk to being OUTPUTs at their last levels */
+void releaseBulkGPIOMem(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    setBulkModeGPIOMem(gpioChip, bulk, OUTPUT);
+}
+
+/* Unmap the GPIO registers */
+void cleanupGPIOMem(struct GPIO_CHIP* gpioChip){
+    munmap((void*)gpioChip->gpioMem, BLOCK_SIZE);
+}
+
+/*****************************************************************************/
+/******************************** backends ***********************************/
+/*****************************************************************************/
+
+#ifndef NO_GPIOD
+static const struct GPIO_BACKEND_OPS LIBGPIOD_BACKEND_OPS = {
+    .setupGPIO = setupLibgpiod,
+    .setPinModeGPIO = setPinModeLibgpiod,
+    .readGPIO = readLibgpiod,
+    .writeGPIO = writeLibgpiod,
+    .cleanupGPIO = cleanupLibgpiod,
+    .requestBulkGPIO = requestBulkLibgpiod,
+    .setBulkModeGPIO = setBulkModeLibgpiod,
+    .readBulkGPIO = readBulkLibgpiod,
+    .writeBulksGPIO = writeBulksLibgpiod,
+    .releaseBulkGPIO = releaseBulkLibgpiod,
+    .requestEventsGPIO = requestEventsLibgpiod,
+    .waitEventGPIO = waitEventLibgpiod,
+    .releaseEventsGPIO = releaseEventsLibgpiod,
+    .setupI2C = setupI2CDev,
+    .readI2C = readI2CDev,
+    .writeI2C = writeI2CDev,
+    .cleanupI2C = cleanupI2CDev
+};
+#endif
+
+static const struct GPIO_BACKEND_OPS GPIOMEM_BACKEND_OPS = {
+    .setupGPIO = setupGPIOMem,
+    .setPinModeGPIO = setPinModeGPIOMem,
+    .readGPIO = readGPIOMem,
+    .writeGPIO = writeGPIOMem,
+    .cleanupGPIO = cleanupGPIOMem,
+    .requestBulkGPIO = requestBulkGPIOMem,
+    .setBulkModeGPIO = setBulkModeGPIOMem,
+    .readBulkGPIO = readBulkGPIOMem,
+    .writeBulksGPIO = writeBulksGPIOMem,
+    .releaseBulkGPIO = releaseBulkGPIOMem,
+    // The registers have no edge events so waits poll the level
+    .requestEventsGPIO = NULL,
+    .waitEventGPIO = NULL,
+    .releaseEventsGPIO = NULL,
+    .setupI2C = setupI2CDev,
+    .readI2C = readI2CDev,
+    .writeI2C = writeI2CDev,
+    .cleanupI2C = cleanupI2CDev
+};
+
+/* Returns the operations of a backend or NULL if it isn't built in */
+static const struct GPIO_BACKEND_OPS* getBackendOps(int backend){
+    switch(backend){
+        #ifndef NO_GPIOD
+        case LIBGPIOD:
+            return &LIBGPIOD_BACKEND_OPS;
+        #endif
+        case GPIOMEM:
+            return &GPIOMEM_BACKEND_OPS;
+        case SIM:
+            return &SIM_BACKEND_OPS;
+        default:
+            return NULL;
+    }
+}
+
+/*****************************************************************************/
+/*****************************************************************************/
+/*****************************************************************************/
+
+/* Sets up GPIO to be used */
+int setupGPIO(struct GPIO_CHIP* gpioChip){
+    int err = 0;
+
+    if(gpioChip == NULL){
+        ulog(ERROR,"gpioChip cannot be NULL");
+        return -1;
+    }
+    if(gpioChip->chipname == NULL){
+        ulog(ERROR,"Chipname cannot be NULL");
+        return -1;
+    }
+    if(gpioChip->consumer == NULL){
+        ulog(ERROR,"Consumer cannot be NULL");
+        return -1;
+    }
+    if(gpioChip->isSetup){
+        ulog(ERROR,"GPIO is already setup");
+        return -1;
+    }
+
+    gpioChip->ops = getBackendOps(gpioBackend);
+    if(gpioChip->ops == NULL){
+        ulog(ERROR,"GPIO backend %s is not available in this build",GPIO_BACKEND_STRINGS[gpioBackend]);
+        return -1;
+    }
+    err = gpioChip->ops->setupGPIO(gpioChip);
+    if(err != -1){
+        gpioChip->isSetup = 1;
+        gpioChip->numLinesInUse = gpioChip->numGPIOLines;
+        // Every backend starts each line as a LOW OUTPUT
+        for(int i=0; i < gpioChip->numLinesInUse; i++){
+            gpioChip->lineModes[i] = OUTPUT;
+            gpioChip->lineLevels[i] = LOW;
+            gpioChip->lineEvents[i] = 0;
+        }
+    }
+
+    return err;
+}
+
+/* Set the GPIO Pin mode to be INPUT or OUTPUT */
+int setPinModeGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int pinMode){
+    if(checkConfigGPIO(gpioChip,gpioLineNumber)){
+        return -1;
+    }
+    if(pinMode != OUTPUT && pinMode != INPUT){
+        ulog(ERROR,"Invalid Pin Mode: %i",pinMode);
+        return -1;
+    }
+
+    if(gpioChip->lineBulk[gpioLineNumber] != NULL){
+        if(gpioChip->lineBulk[gpioLineNumber]->direction != pinMode){
+            ulog(ERROR,"Pin: %i is part of a bulk. Set the mode of the bulk instead.",gpioLineNumber);
+            return -1;
+        }
+        return 0;
+    }
+    if(gpioChip->lineModes[gpioLineNumber] == pinMode){
+        return 0;
+    }
+    if(gpioChip->lineEvents[gpioLineNumber]){
+        ulog(ERROR,"Pin: %i has edge events requested. Release them first.",gpioLineNumber);
+        return -1;
+    }
+
+    int err = gpioChip->ops->setPinModeGPIO(gpioChip, gpioLineNumber, pinMode);
+    if(!err){
+        gpioChip->lineModes[gpioLineNumber] = pinMode;
+    }
+    return err;
+}
+
+/* Read from a specified GPIO Pin */
+int readGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    if(checkConfigGPIO(gpioChip,gpioLineNumber)){
+        return -1;
+    }
+
+    struct GPIO_BULK* bulk = gpioChip->lineBulk[gpioLineNumber];
+    if((bulk != NULL && bulk->direction != INPUT) || (bulk == NULL && gpioChip->lineModes[gpioLineNumber] != INPUT)){
+        ulog(ERROR,"Pin: %i not configured as INPUT. Cannot be read.",gpioLineNumber);
+        return -1;
+    }
+
+    return readGPIOUnchecked(gpioChip, gpioLineNumber);
+}
+
+/* Read from a GPIO Pin that has already been validated */
+int readGPIOUnchecked(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    if(gpioChip->lineBulk[gpioLineNumber] != NULL){
+        int val = readBulkGPIOUnchecked(gpioChip, gpioChip->lineBulk[gpioLineNumber]);
+        if(val == -1){
+            return -1;
+        }
+        return (val >> gpioChip->lineBulkOffset[gpioLineNumber]) & 1;
+    }
+
+    return gpioChip->ops->readGPIO(gpioChip, gpioLineNumber);
+}
+
+/* Write a level to a specified GPIO Pin */
+int writeGPIO(struct GPIO_CHIP* gpioChip,int gpioLineNumber,int level){
+    if(checkConfigGPIO(gpioChip,gpioLineNumber)){
+        return -1;
+    }
+    if(level != 0 && level != 1){
+        ulog(ERROR,"Invalid level %i for line: %i", level,gpioLineNumber);
+        return -1;
+    }
+
+    struct GPIO_BULK* bulk = gpioChip->lineBulk[gpioLineNumber];
+    if((bulk != NULL && bulk->direction != OUTPUT) || (bulk == NULL && gpioChip->lineModes[gpioLineNumber] != OUTPUT)){
+        ulog(ERROR,"Pin: %i not configured as OUTPUT. Cannot be written.",gpioLineNumber);
+        return -1;
+    }
+
+    return writeGPIOUnchecked(gpioChip, gpioLineNumber, level);
+}
+
+/* Write a level to a GPIO Pin that has already been validated */
+int writeGPIOUnchecked(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level){
+    if(gpioChip->lineBulk[gpioLineNumber] != NULL){
+        struct GPIO_BULK* bulk = gpioChip->lineBulk[gpioLineNumber];
+        unsigned int levels = bulk->levels;
+        levels &= ~(1u << gpioChip->lineBulkOffset[gpioLineNumber]);
+        levels |= level << gpioChip->lineBulkOffset[gpioLineNumber];
+        return writeBulksGPIOUnchecked(gpioChip, &bulk, &levels, 1);
+    }
+    if(gpioChip->lineLevels[gpioLineNumber] == level){
+        return 0;
+    }
+
+    int err = gpioChip->ops->writeGPIO(gpioChip, gpioLineNumber, level);
+    if(!err){
+        gpioChip->lineLevels[gpioLineNumber] = level;
+    }
+    return err;
+}
+
+/* Request a group of GPIO lines together */
+int requestBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int* gpioLineNumbers, \
+                                                        int numLines, int direction, unsigned int levels){
+    int err = 0;
+
+    if(bulk == NULL || gpioLineNumbers == NULL){
+        ulog(ERROR,"Bulk and line numbers cannot be NULL.");
+        return -1;
+    }
+    if(numLines <= 0 || numLines > MAX_BULK_LINES){
+        ulog(ERROR,"Invalid number of lines for bulk: %i. Max: %i",numLines,MAX_BULK_LINES);
+        return -1;
+    }
+    if(direction != INPUT && direction != OUTPUT){
+        ulog(ERROR,"Invalid Pin Mode: %i",direction);
+        return -1;
+    }
+    for(int i = 0; i < numLines; i++){
+        if(checkConfigGPIO(gpioChip, gpioLineNumbers[i])){
+            return -1;
+        }
+        if(gpioChip->lineBulk[gpioLineNumbers[i]] != NULL){
+            ulog(ERROR,"Pin: %i is already part of a bulk.",gpioLineNumbers[i]);
+            return -1;
+        }
+        if(gpioChip->lineEvents[gpioLineNumbers[i]]){
+            ulog(ERROR,"Pin: %i has edge events requested. Release them first.",gpioLineNumbers[i]);
+            return -1;
+        }
+    }
+
+    bulk->numLines = numLines;
+    bulk->direction = direction;
+    for(int i = 0; i < numLines; i++){
+        bulk->lines[i] = gpioLineNumbers[i];
+        bulk->values[i] = (levels >> i) & 1;
+    }
+    bulk->levels = levels & ((1u << numLines) - 1);
+    buildBulkTablesGPIO(bulk);
+
+    err = gpioChip->ops->requestBulkGPIO(gpioChip, bulk);
+    if(err){
+        ulog(ERROR,"Error requesting bulk of %i lines",numLines);
+        bulk->isRequested = 0;
+        return -1;
+    }
+
+    for(int i = 0; i < numLines; i++){
+        gpioChip->lineBulk[gpioLineNumbers[i]] = bulk;
+        gpioChip->lineBulkOffset[gpioLineNumbers[i]] = i;
+    }
+    bulk->isRequested = 1;
+    return 0;
+}
+
+/* Set every line of a bulk to be INPUT or OUTPUT */
+int setBulkModeGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int direction){
+    int err = 0;
+
+    if(checkBulkGPIO(gpioChip, bulk)){
+        return -1;
+    }
+    if(direction != INPUT && direction != OUTPUT){
+        ulog(ERROR,"Invalid Pin Mode: %i",direction);
+        return -1;
+    }
+    if(bulk->direction == direction){
+        return 0;
+    }
+
+    err = gpioChip->ops->setBulkModeGPIO(gpioChip, bulk, direction);
+    if(!err){
+        bulk->direction = direction;
+    }
+    return err;
+}
+
+/* Read every line of a bulk */
+int readBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    if(checkBulkGPIO(gpioChip, bulk)){
+        return -1;
+    }
+    if(bulk->direction != INPUT){
+        ulog(ERROR,"Bulk not configured as INPUT. Cannot be read.");
+        return -1;
+    }
+
+    return readBulkGPIOUnchecked(gpioChip, bulk);
+}
+
+/* Read every line of a bulk that has already been validated */
+int readBulkGPIOUnchecked(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    return gpioChip->ops->readBulkGPIO(gpioChip, bulk);
+}
+
+/* Write the levels of every line of a bulk */
+int writeBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, unsigned int levels){
+    return writeBulksGPIO(gpioChip, &bulk, &levels, 1);
+}
+
+/* Write the levels of several bulks at once */
+int writeBulksGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, unsigned int* levels, int numBulks){
+    for(int j = 0; j < numBulks; j++){
+        if(checkBulkGPIO(gpioChip, bulks[j])){
+            return -1;
+        }
+        if(bulks[j]->direction != OUTPUT){
+            ulog(ERROR,"Bulk not configured as OUTPUT. Cannot be written.");
+            return -1;
+        }
+    }
+
+    return writeBulksGPIOUnchecked(gpioChip, bulks, levels, numBulks);
+}
+
+/* Write the levels of several bulks that have already been validated */
+int writeBulksGPIOUnchecked(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, unsigned int* levels, int numBulks){
+    int changed = 0;
+    for(int j = 0; j < numBulks; j++){
+        unsigned int bulkLevels = levels[j] & ((1u << bulks[j]->numLines) - 1);
+        if(bulks[j]->levels != bulkLevels){
+            changed = 1;
+            bulks[j]->levels = bulkLevels;
+            for(int i = 0; i < bulks[j]->numLines; i++){
+                bulks[j]->values[i] = (bulkLevels >> i) & 1;
+            }
+        }
+    }
+    if(!changed){
+        return 0;
+    }
+
+    return gpioChip->ops->writeBulksGPIO(gpioChip, bulks, numBulks);
+}
+
+/* Release a bulk and request its lines individually again */
+void releaseBulkGPIO(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    if(checkBulkGPIO(gpioChip, bulk)){
+        return;
+    }
+    for(int i = 0; i < bulk->numLines; i++){
+        gpioChip->lineBulk[bulk->lines[i]] = NULL;
+        gpioChip->lineModes[bulk->lines[i]] = OUTPUT;
+        gpioChip->lineLevels[bulk->lines[i]] = bulk->values[i];
+    }
+    gpioChip->ops->releaseBulkGPIO(gpioChip, bulk);
+    bulk->isRequested = 0;
+}
+
+/* Request edge events on an INPUT line */
+int requestEventsGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    if(checkConfigGPIO(gpioChip,gpioLineNumber)){
+        return -1;
+    }
+    if(gpioChip->lineBulk[gpioLineNumber] != NULL || gpioChip->lineModes[gpioLineNumber] != INPUT){
+        ulog(ERROR,"Pin: %i not configured as INPUT. Cannot request edge events.",gpioLineNumber);
+        return -1;
+    }
+    if(gpioChip->lineEvents[gpioLineNumber]){
+        return 0;
+    }
+    if(gpioChip->ops->requestEventsGPIO == NULL){
+        ulog(DEBUG,"GPIO backend %s has no edge events",GPIO_BACKEND_STRINGS[gpioBackend]);
+        return -1;
+    }
+
+    int err = gpioChip->ops->requestEventsGPIO(gpioChip, gpioLineNumber);
+    if(!err){
+        gpioChip->lineEvents[gpioLineNumber] = 1;
+    }
+    return err;
+}
+
+/* Wait until an INPUT line is at a level sleeping on edge events if possible */
+int waitLevelGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level, int timeoutMSec){
+    struct timespec now;
+    long long deadline = 0;
+    long long remaining = 0;
+
+    if(level != 0 && level != 1){
+        ulog(ERROR,"Invalid level %i for line: %i", level,gpioLineNumber);
+        return -1;
+    }
+    if(timeoutMSec < 0){
+        ulog(ERROR,"Invalid timeout: %i",timeoutMSec);
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    deadline = now.tv_sec * 1000000LL + now.tv_nsec / 1000 + timeoutMSec * 1000LL;
+
+    // The level is read before every sleep. An edge between the read and the
+    // sleep is queued by the kernel so the sleep returns at once for it
+    while(1){
+        int val = readGPIO(gpioChip, gpioLineNumber);
+        if(val == -1){
+            return -1;
+        }
+        if(val == level){
+            return 0;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        remaining = deadline - (now.tv_sec * 1000000LL + now.tv_nsec / 1000);
+        if(remaining <= 0){
+            return 1;
+        }
+        if(gpioChip->lineEvents[gpioLineNumber]){
+            if(gpioChip->ops->waitEventGPIO(gpioChip, gpioLineNumber, (remaining + 999) / 1000) == -1){
+                return -1;
+            }
+        } else {
+            usleep(remaining < LEVEL_POLL_USEC ? remaining : LEVEL_POLL_USEC);
+        }
+    }
+}
+
+/* Release the edge events of a line */
+void releaseEventsGPIO(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    if(checkConfigGPIO(gpioChip,gpioLineNumber) || !gpioChip->lineEvents[gpioLineNumber]){
+        return;
+    }
+    gpioChip->ops->releaseEventsGPIO(gpioChip, gpioLineNumber);
+    gpioChip->lineEvents[gpioLineNumber] = 0;
+}
+
+/* Release the chip and GPIO lines */
+void cleanupGPIO(struct GPIO_CHIP* gpioChip){
+    if(gpioChip->isSetup){
+        gpioChip->isSetup = 0;
+        // Backends may still need the bulks to release their lines
+        gpioChip->ops->cleanupGPIO(gpioChip);
+        for(int i=0; i < gpioChip->numLinesInUse; i++){
+            if(gpioChip->lineBulk[i] != NULL){
+                gpioChip->lineBulk[i]->isRequested = 0;
+                gpioChip->lineBulk[i] = NULL;
+            }
+            gpioChip->lineEvents[i] = 0;
+        }
+    }
+
+}
+
+/*****************************************************************************/
+/*****************************************************************************/
+/*****************************************************************************/
+
+/* Sets up an I2C device to be used on the specified I2C bus */
+int setupI2C(int bus, char I2CId){
+    const struct GPIO_BACKEND_OPS* ops = getBackendOps(gpioBackend);
+    if(ops == NULL){
+        ulog(ERROR,"GPIO backend %s is not available in this build",GPIO_BACKEND_STRINGS[gpioBackend]);
+        return -1;
+    }
+    return ops->setupI2C(bus, I2CId);
+}
+
+/* Read from a specified address via I2C */
+int readI2C(int fd, char* buf, int numBytesToRead, int addressSize){
+    return getBackendOps(gpioBackend)->readI2C(fd, buf, numBytesToRead, addressSize);
+}
+
+/* Write page to a specified address via I2C */
+int writeI2C(int fd, char* data, int numBytesToWrite){
+    return getBackendOps(gpioBackend)->writeI2C(fd, data, numBytesToWrite);
+}
+
+/* Closes a specified I2C device */
+void cleanupI2C(int fd){
+    getBackendOps(gpioBackend)->cleanupI2C(fd);
+}
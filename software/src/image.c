@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "image.h"
+#include "ulog.h"
+
+/* Move the bytes of a streamed image up to address out of the buffer. Bytes past the
+   end of the buffer are read from the pipe and dropped */
+static int dropImageBytes(struct IMAGE* image, long address){
+    long numBytes = address - image->address;
+    if(numBytes < image->size){
+        memmove(image->data, image->data + numBytes, image->size - numBytes);
+        image->size -= numBytes;
+        image->address = address;
+        return 0;
+    }
+    numBytes -= image->size;
+    image->address += image->size;
+    image->size = 0;
+    while(numBytes > 0){
+        size_t bytesRead = fread(image->data, 1, \
+                        numBytes < IMAGE_BUFFER_SIZE ? numBytes : IMAGE_BUFFER_SIZE, image->stream);
+        if(bytesRead == 0){
+            break;
+        }
+        image->address += bytesRead;
+        numBytes -= bytesRead;
+    }
+    return ferror(image->stream) ? -1 : 0;
+}
+
+/* Map romFile into memory or stream it through a buffer if it cannot be mapped */
+int openImage(FILE* romFile, struct IMAGE* image){
+    struct stat fileStat;
+    int fd = fileno(romFile);
+
+    image->data = NULL;
+    image->address = 0;
+    image->size = 0;
+    image->isMapped = 0;
+    image->stream = NULL;
+
+    if(fd != -1 && fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode)){
+        if(fileStat.st_size == 0){
+            return 0;
+        }
+        void* map = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(map != MAP_FAILED){
+            // Pages are written and compared in order so the kernel may read ahead
+            madvise(map, fileStat.st_size, MADV_SEQUENTIAL);
+            image->data = map;
+            image->size = fileStat.st_size;
+            image->isMapped = 1;
+            return 0;
+        }
+        ulog(DEBUG,"Unable to map the file. Streaming it instead");
+        rewind(romFile);
+    }
+
+    char* buffer = malloc(IMAGE_HEADROOM + IMAGE_BUFFER_SIZE);
+    if(buffer == NULL){
+        ulog(ERROR,"Unable to allocate memory for the file");
+        return -1;
+    }
+    image->data = buffer + IMAGE_HEADROOM;
+    image->stream = romFile;
+    return 0;
+}
+
+/* Point bytes at up to numBytes of the image starting at address */
+int getImageBytes(struct IMAGE* image, long address, int numBytes, char** bytes){
+    if(address < 0){
+        return 0;
+    }
+    if(image->stream != NULL){
+        if(address < image->address){
+            ulog(ERROR,"Unable to go back to address %li of a piped file", address);
+            return -1;
+        }
+        if(numBytes > IMAGE_BUFFER_SIZE){
+            numBytes = IMAGE_BUFFER_SIZE;
+        }
+        if(dropImageBytes(image, address) == -1){
+            ulog(ERROR,"Unable to read the file");
+            return -1;
+        }
+        // Only the bytes asked for are waited on so writing starts while the pipe is
+        // still being written
+        while(image->size < numBytes && !feof(image->stream)){
+            size_t bytesRead = fread(image->data + image->size, 1, numBytes - image->size, image->stream);
+            if(bytesRead == 0 && ferror(image->stream)){
+                ulog(ERROR,"Unable to read the file");
+                return -1;
+            }
+            image->size += bytesRead;
+        }
+    }
+    if(address >= image->address + image->size){
+        return 0;
+    }
+    if(numBytes > image->address + image->size - address){
+        numBytes = image->address + image->size - address;
+    }
+    *bytes = image->data + (address - image->address);
+    return numBytes;
+}
+
+/* Unmap or free the contents of the image */
+void closeImage(struct IMAGE* image){
+    if(image->isMapped){
+        munmap(image->data, image->size);
+    } else if(image->stream != NULL){
+        free(image->data - IMAGE_HEADROOM);
+    }
+    image->data = NULL;
+    image->address = 0;
+    image->size = 0;
+    image->isMapped = 0;
+    image->stream = NULL;
+}
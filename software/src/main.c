@@ -1,5 +1,8 @@
 #include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
 
+#include "gang.h"
 #include "piepro.h"
 
 int main(int argc, char *argv[]){	
@@ -14,6 +17,7 @@ int main(int argc, char *argv[]){
         struct EEPROM eeprom;
         struct GPIO_CONFIG gpioConfig;
         struct OPTIONS options;
+        struct GANG_RESULT gangResult;
 		
         if(parseCommandLineOptions(&options, argc, argv)){
             fprintf(stderr,"Error parsing command line options\n");
@@ -27,25 +31,41 @@ int main(int argc, char *argv[]){
         
         /*********************************************************************/
         /************************* Program  Start ****************************/
+        // Writes, compares and erases run on every I2C bus at once
+        int useGang = options.numI2CBuses > 1 && eeprom.type == I2C;
         switch(options.action){
             case WRITE_FILE_TO_ROM:
             case COMPARE_FILE_TO_ROM:
             {
-                // open file to read
-                FILE* romFile = fopen(options.filename, "r");
+                // open file to read. - reads the file from stdin
+                int isStdin = strcmp(options.filename, "-") == 0;
+                FILE* romFile = isStdin ? stdin : fopen(options.filename, "r");
                 if(romFile == NULL){
                     fprintf(stderr,"Error Opening File\n");
                     error = -1;
                     break;
                 }
-                if(options.action == WRITE_FILE_TO_ROM){
+                // Each bus opens the file itself so a pipe could only be read by one
+                struct stat fileStat;
+                if(useGang && (fstat(fileno(romFile), &fileStat) || !S_ISREG(fileStat.st_mode))){
+                    fprintf(stderr,"A piped file can not be used with more than one I2C bus\n");
+                    error = -1;
+                } else if(options.action == WRITE_FILE_TO_ROM && isStdin && options.promptUser){
+                    fprintf(stderr,"Writing a file from stdin needs --yes\n");
+                    error = -1;
+                } else if(options.action == WRITE_FILE_TO_ROM){
                     char confirmation = 'n';
                     if(options.promptUser){
                         printf("Are you sure you want to write to the EEPROM? y/N\n");
                         confirmation = getchar();  
                     }    
                     if(confirmation == 'y' || confirmation == 'Y' || !options.promptUser){
-                        error = writeFileToEEPROM(&gpioConfig, &eeprom, romFile);
+                        if(useGang){
+                            error = runGangI2C(&options, &gpioConfig, &eeprom, &gangResult);
+                            printGangResult(&gangResult, options.action);
+                        } else {
+                            error = writeFileToEEPROM(&gpioConfig, &eeprom, romFile);
+                        }
                         fprintf(stdout,"Wrote %i bytes\n", eeprom.byteWriteCounter);
                     } else {
                         printf("Aborting write operation.\n");
@@ -53,7 +73,13 @@ int main(int argc, char *argv[]){
                     }
 
                 } else {
-                    int bytesNotMatched = compareFileToEEPROM(&gpioConfig, &eeprom, romFile);
+                    int bytesNotMatched;
+                    if(useGang){
+                        bytesNotMatched = runGangI2C(&options, &gpioConfig, &eeprom, &gangResult);
+                        printGangResult(&gangResult, options.action);
+                    } else {
+                        bytesNotMatched = compareFileToEEPROM(&gpioConfig, &eeprom, romFile);
+                    }
                     if(bytesNotMatched == 0) {
                         fprintf(stdout,"All bytes match\n");
                     } else if(bytesNotMatched == -1){
@@ -64,7 +90,9 @@ int main(int argc, char *argv[]){
                         fprintf(stderr,"%i bytes do not match\n", bytesNotMatched);
                     }
                 }
-                fclose(romFile);   
+                if(!isStdin){
+                    fclose(romFile);
+                }
                 break;
             }
             case DUMP_ROM:
@@ -78,7 +106,12 @@ int main(int argc, char *argv[]){
                     confirmation = getchar();  
                 }
                 if(confirmation == 'y' || confirmation == 'Y' || !options.promptUser){
-                    error = eraseEEPROM(&gpioConfig, &eeprom, options.eraseByte);
+                    if(useGang){
+                        error = runGangI2C(&options, &gpioConfig, &eeprom, &gangResult);
+                        printGangResult(&gangResult, options.action);
+                    } else {
+                        error = eraseEEPROM(&gpioConfig, &eeprom, options.eraseByte);
+                    }
                 } else {
                     printf("Aborting erase operation.\n");
                     break;
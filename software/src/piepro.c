@@ -1,77 +1,206 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
-#include <unistd.h>
 
+#include "delay.h"
+#include "image.h"
 #include "piepro.h"
+#include "rt.h"
+#include "sim.h"
 #include "utils.h"
 #include "gpio.h"
 #include "ulog.h"
+#include "wcycle.h"
 
 static char* const chipname = "gpiochip0";
 static char* const consumer = "Pi EEPROM Programmer";
 
+// The byte load cycle time(tBLC). A page load ends if the next /WE pulse does
+// not start within it so it also bounds the length of a /WE pulse
+#define BYTE_LOAD_CYCLE_NSEC 150000
+// Bytes of a page latched within this of each other are known to be inside tBLC
+#define BYTE_LOAD_WINDOW_NSEC 100000
+// RDY/BUSY only goes LOW once the write cycle starts. For a page that is up to
+// tBLC after the last byte is latched
+#define BUSY_START_TIMEOUT_MSEC 1
+#define DEFAULT_WRITE_TIMEOUT_MSEC 5000
+// Every this many write cycles waited with a learned delay are polled instead to check it
+#define LEARNED_DELAY_CHECK_INTERVAL 64
+// Largest number of bytes read at once from a parallel EEPROM
+#define MAX_PARALLEL_READ_CHUNK 8192
+// Largest number of bytes read at once from an I2C EEPROM. One block of the parts
+// that take high address bits in the I2C id so larger parts are streamed through
+// buffers of a bounded size
+#define MAX_I2C_READ_CHUNK 65536
+// I2C acknowledge polls back off by doubling the wait between them up to the maximum
+#define I2C_POLL_MIN_NSEC 50000
+#define I2C_POLL_MAX_NSEC 400000
+// Binary files are diffed against the EEPROM this many bytes at a time. A multiple
+// of every page size so a page is never split between two windows
+#define PLAN_WINDOW_SIZE 4096
+// Time to send one byte over I2C. 9 clocks at 100 kHz
+#define PLAN_I2C_BYTE_NSEC 90000
+
 const char* EEPROM_MODEL_STRINGS[] = 	{
 										"xl2816","xl28c16", 
 										"at28c16","at28c64","at28c256", 
 										"at24c01","at24c02","at24c04","at24c08","at24c16",
-										"at24c32","at24c64","at24c128","at24c256","at24c512"
+										"at24c32","at24c64","at24c128","at24c256","at24c512",
+										"at24cm01","at24cm02"
 										};
 
 const int EEPROM_MODEL_SIZE[] = 	{
 									2048,2048,
 									2048,8192,32768,
 									128,256,512,1024,2048,
-									4096,8192,16384,32768,65536
+									4096,8192,16384,32768,65536,
+									131072,262144
 									};
 
 const int EEPROM_ADDRESS_LENGTH[] = {	
 									11,11,
 									11,13,15,
 									7,8,9,10,11,
-									12,13,14,15,16
+									12,13,14,15,16,
+									17,18
 									};
 
 const int EEPROM_DATA_LENGTH[] = 	{
 									8,8,
 									8,8,8,
 									8,8,8,8,8,
-									8,8,8,8,8
+									8,8,8,8,8,
+									8,8
 									};
 									
 const int EEPROM_WRITE_CYCLE_USEC[] = 	{
 										10000,10000,
-										5000,10000,1000,
+										5000,10000,10000,
 										5000,5000,5000,5000,5000,
-										5000,5000,5000,5000,5000
+										5000,5000,5000,5000,5000,
+										5000,10000
 										};
 
+// The AT28C64 and AT28C256 also toggle I/O6 while a write cycle is in progress
+const int EEPROM_POLLING_METHOD[] = {
+										DATA_POLLING,DATA_POLLING,
+										DATA_POLLING,TOGGLE_BIT_POLLING,TOGGLE_BIT_POLLING,
+										DATA_POLLING,DATA_POLLING,DATA_POLLING,DATA_POLLING,DATA_POLLING,
+										DATA_POLLING,DATA_POLLING,DATA_POLLING,DATA_POLLING,DATA_POLLING,
+										DATA_POLLING,DATA_POLLING
+										};
+
+const char* POLLING_METHOD_STRINGS[] = {"data","toggle","ready"};
+
 const int EEPROM_PAGE_SIZE[] = 	{
 									16,16,
 									16,16,64,
 									8,8,16,16,16,
-									32,32,64,64,128
+									32,32,64,64,128,
+									256,256
+									};
+
+// The AT28C16 and the XL2816 only write one byte per write cycle
+const int EEPROM_PAGE_WRITE[] = 	{
+									0,0,
+									0,1,1,
+									1,1,1,1,1,
+									1,1,1,1,1,
+									1,1
 									};
 
+// The AT28C256 erases every byte to 0xFF with the JEDEC software chip erase sequence.
+// This is how long the chip erase takes(tEC). 0 where it is not supported. The AT28C64
+// datasheet only has a chip clear with 12V on OE which the programmer can not supply
+const int EEPROM_CHIP_ERASE_USEC[] = 	{
+										0,0,
+										0,0,20000,
+										0,0,0,0,0,
+										0,0,0,0,0,
+										0,0
+										};
+
 const int EEPROM_ADDRESS_SIZE[] = 	{
 										0,0,
 										0,0,0,
 										1,1,2,2,2,
-										2,2,2,2,2
+										2,2,2,2,2,
+										2,2
+										};
+
+// The AT24CM01 and AT24CM02 take address bits 16 and 17 in the low bits of the I2C id
+const int EEPROM_I2C_BLOCKS[] = 	{
+										1,1,
+										1,1,1,
+										1,1,1,1,1,
+										1,1,1,1,1,
+										2,4
+										};
+
+// Parallel timings are the minimums of the fastest speed grade that is common
+// for each model. I2C EEPROMs are timed by the I2C bus so they are unused
+const int EEPROM_ADDRESS_SETUP_NSEC[] = {
+										20,20,
+										10,10,0,
+										0,0,0,0,0,
+										0,0,0,0,0,
+										0,0
+										};
+
+const int EEPROM_WRITE_PULSE_NSEC[] = {
+										150,150,
+										100,100,100,
+										0,0,0,0,0,
+										0,0,0,0,0,
+										0,0
+										};
+
+const int EEPROM_DATA_SETUP_NSEC[] = {
+										50,50,
+										50,50,50,
+										0,0,0,0,0,
+										0,0,0,0,0,
+										0,0
+										};
+
+const int EEPROM_OUTPUT_ENABLE_NSEC[] = {
+										100,100,
+										70,70,70,
+										0,0,0,0,0,
+										0,0,0,0,0,
+										0,0
+										};
+
+const int EEPROM_ADDRESS_ACCESS_NSEC[] = {
+										250,250,
+										150,150,150,
+										0,0,0,0,0,
+										0,0,0,0,0,
+										0,0
+										};
+
+// Parallel EEPROMs are powered before piepro starts so only the read power up
+// time applies. I2C EEPROMs are powered up by the vcc pin during setup
+const int EEPROM_POWER_UP_USEC[] = {
+										100,100,
+										100,100,100,
+										5000,5000,5000,5000,5000,
+										5000,5000,5000,5000,5000,
+										5000,5000
 										};
 
 /******************************************************************************
 *******************************************************************************
 ******************************************************************************/
 
-/* Local function wrapper to writeGPIO  */
+/* Local function wrapper to writeGPIO. Pins are fixed and validated by setupGPIO */
 void setPinLevel(struct GPIO_CONFIG* gpioConfig, int pin, int level){
-	writeGPIO(&gpioConfig->gpioChip, pin, level);
+	writeGPIOUnchecked(&gpioConfig->gpioChip, pin, level);
 }
 
-/* Local function wrapper to readGPIO  */
+/* Local function wrapper to readGPIO. Pins are fixed and validated by setupGPIO */
 int getPinLevel(struct GPIO_CONFIG* gpioConfig, int pin){
-	return readGPIO(&gpioConfig->gpioChip, pin);
+	return readGPIOUnchecked(&gpioConfig->gpioChip, pin);
 }
 
 /* Local function wrapper to setPinModeGPIO  */
@@ -79,81 +208,363 @@ void setPinMode(struct GPIO_CONFIG* gpioConfig, int pin, int mode){
 	setPinModeGPIO(&gpioConfig->gpioChip, pin, mode);
 }
 
-/* Set Address eeprom to value to read from or write to */
+/* Set Address eeprom to value to read from or write to. Only the pins that differ
+   from the last address set are changed */
 void setAddressPins(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, int addressToSet){
-	for (char pin = 0; pin < eeprom->maxAddressLength; pin++){
+	if(eeprom->addressBus.isRequested){
+		struct GPIO_BULK* bus = &eeprom->addressBus;
+		unsigned int levels = addressToSet;
+		writeBulksGPIOUnchecked(&gpioConfig->gpioChip, &bus, &levels, 1);
+		eeprom->lastAddress = addressToSet;
+		return;
+	}
+	int changedBits = (eeprom->lastAddress == -1) ? -1 : (addressToSet ^ eeprom->lastAddress);
+	eeprom->lastAddress = addressToSet;
+	for (char pin = 0; pin < eeprom->maxAddressLength && changedBits != 0; pin++){
 		if (!((eeprom->model == AT28C64) && ((pin == 13) || (pin == 14)))){
-			setPinLevel(gpioConfig, eeprom->addressPins[(int)pin], (addressToSet & 1));
+			if(changedBits & 1){
+				setPinLevel(gpioConfig, eeprom->addressPins[(int)pin], (addressToSet & 1));
+			}
 			addressToSet >>= 1;
+			changedBits = (unsigned int)changedBits >> 1;
 		}
 	}
 }
 
 /* Set Data eeprom to value to write */
 void setDataPins(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char dataToSet){
+	if(eeprom->dataBus.isRequested){
+		struct GPIO_BULK* bus = &eeprom->dataBus;
+		unsigned int levels = (unsigned char)dataToSet;
+		writeBulksGPIOUnchecked(&gpioConfig->gpioChip, &bus, &levels, 1);
+		return;
+	}
 	for (char pin = 0; pin < eeprom->maxDataLength; pin++){
 		setPinLevel(gpioConfig, eeprom->dataPins[(int)pin], (dataToSet & 1));
 		dataToSet >>= 1;
 	}
 }
 
+/* Set the address and data together. One register pair when using gpiomem */
+void setAddressAndDataPins(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, int addressToSet, char dataToSet){
+	if(eeprom->addressBus.isRequested && eeprom->dataBus.isRequested){
+		struct GPIO_BULK* buses[2] = {&eeprom->addressBus, &eeprom->dataBus};
+		unsigned int levels[2] = {addressToSet, (unsigned char)dataToSet};
+		writeBulksGPIOUnchecked(&gpioConfig->gpioChip, buses, levels, 2);
+		eeprom->lastAddress = addressToSet;
+	} else {
+		setAddressPins(gpioConfig, eeprom, addressToSet);
+		setDataPins(gpioConfig, eeprom, dataToSet);
+	}
+}
+
+/* Read the value on the data pins */
+int getDataPins(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom){
+	int byteVal = 0;
+	if(eeprom->dataBus.isRequested){
+		return readBulkGPIOUnchecked(&gpioConfig->gpioChip, &eeprom->dataBus);
+	}
+	for(int i = eeprom->maxDataLength-1; i >= 0; i--){
+		byteVal <<= 1;
+		byteVal |= (getPinLevel(gpioConfig, eeprom->dataPins[i]) & 1);
+	}
+	return byteVal;
+}
+
+/* Set the data pins to INPUT or OUTPUT. Nothing is changed if they already are */
+void setDataPinsMode(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, int mode){
+	if(eeprom->dataBus.isRequested){
+		setBulkModeGPIO(&gpioConfig->gpioChip, &eeprom->dataBus, mode);
+		return;
+	}
+	for(int i = 0; i < eeprom->maxDataLength; i++){
+		setPinMode(gpioConfig, eeprom->dataPins[i], mode);
+	}
+}
+
+/* Group the parallel bus pins so each bus can be driven with one call */
+void requestBusPins(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom){
+	int addressLines[MAX_ADDRESS_PINS];
+	int numAddressLines = 0;
+	int controlLines[3] = {eeprom->chipEnablePin, eeprom->outputEnablePin, eeprom->writeEnablePin};
+
+	for(int i = 0; i < eeprom->maxAddressLength; i++){
+		if (!((eeprom->model == AT28C64) && ((i == 13) || (i == 14)))){
+			addressLines[numAddressLines++] = eeprom->addressPins[i];
+		}
+	}
+
+	// CE LOW, OE HIGH, WE HIGH
+	if(requestBulkGPIO(&gpioConfig->gpioChip, &eeprom->controlBus, controlLines, 3, OUTPUT, 0x6)){
+		ulog(WARNING,"Unable to group control pins. Falling back to single pin access.");
+	}
+	if(requestBulkGPIO(&gpioConfig->gpioChip, &eeprom->addressBus, addressLines, numAddressLines, OUTPUT, 0)){
+		ulog(WARNING,"Unable to group address pins. Falling back to single pin access.");
+	}
+	if(requestBulkGPIO(&gpioConfig->gpioChip, &eeprom->dataBus, eeprom->dataPins, eeprom->maxDataLength, INPUT, 0)){
+		ulog(WARNING,"Unable to group data pins. Falling back to single pin access.");
+	}
+}
+
+/* Wait for I/O7 to match the last byte written. Returns the number of reads that
+   saw the write cycle still in progress or -1 if the deadline passed */
+int pollDataBit(struct EEPROM* eeprom, struct GPIO_CONFIG* gpioConfig, int dataToCheck, long long deadline){
+	int busyPolls = 0;
+	setDataPinsMode(gpioConfig, eeprom, INPUT);
+	setPinLevel(gpioConfig, eeprom->outputEnablePin, LOW);
+	delayNSec(eeprom->outputEnableTime);
+	while(getPinLevel(gpioConfig, eeprom->dataPins[7]) ^ ((dataToCheck >> 7) & 1)){
+		if(getTimeNSec() > deadline){
+			return -1;
+		}
+		busyPolls++;
+	}
+	return busyPolls;
+}
+
+/* Wait for I/O6 to stop toggling. Every read toggles I/O6 until the write cycle finishes
+   so the written data is not needed. Each read needs its own falling edge of OE.
+   Returns the number of reads that saw I/O6 toggle or -1 if the deadline passed */
+int pollToggleBit(struct EEPROM* eeprom, struct GPIO_CONFIG* gpioConfig, long long deadline){
+	int lastToggleBit = -1;
+	int toggleBit = -1;
+	int busyPolls = -1;
+	setDataPinsMode(gpioConfig, eeprom, INPUT);
+	do {
+		if(getTimeNSec() > deadline){
+			return -1;
+		}
+		lastToggleBit = toggleBit;
+		setPinLevel(gpioConfig, eeprom->outputEnablePin, HIGH);
+		setPinLevel(gpioConfig, eeprom->outputEnablePin, LOW);
+		delayNSec(eeprom->outputEnableTime);
+		toggleBit = getPinLevel(gpioConfig, eeprom->dataPins[6]);
+		busyPolls++;
+	} while(toggleBit != lastToggleBit);
+	return busyPolls - 1;
+}
+
+/* Sleep until RDY/BUSY goes LOW and back HIGH. Falls back to the model's polling
+   method if it never goes LOW. Returns 1 once the write cycle has been seen to
+   finish or -1 if the deadline passed */
+int waitReadyBusy(struct EEPROM* eeprom, struct GPIO_CONFIG* gpioConfig, int dataToCheck, long long deadline){
+	int ret = waitLevelGPIO(&gpioConfig->gpioChip, eeprom->readyBusyPin, LOW, BUSY_START_TIMEOUT_MSEC);
+	if(ret == 0){
+		long long remaining = deadline - getTimeNSec();
+		ret = waitLevelGPIO(&gpioConfig->gpioChip, eeprom->readyBusyPin, HIGH, \
+												remaining > 0 ? (remaining + 999999) / 1000000 : 0);
+		if(ret != -1){
+			return ret == 0 ? 1 : -1;
+		}
+	}
+	ulog(DEBUG,"RDY/BUSY did not go LOW. Polling instead.");
+	if(EEPROM_POLLING_METHOD[eeprom->model] == TOGGLE_BIT_POLLING){
+		return pollToggleBit(eeprom, gpioConfig, deadline);
+	}
+	return pollDataBit(eeprom, gpioConfig, dataToCheck, deadline);
+}
+
+/* Records a polled write cycle and falls back to the datasheet write cycle time
+   if it was a check of the learned delay that took longer */
+int recordPolledWriteCycle(struct EEPROM* eeprom, long long start, long long end, int busyPolls, \
+																		int checkLearnedDelay){
+	if(busyPolls == -1){
+		ulog(WARNING,"Write cycle did not finish within %i ms",eeprom->writeTimeout);
+		return -1;
+	}
+	long long elapsed = end - start;
+	recordWriteCycle(elapsed, busyPolls == 0);
+	// A write cycle that finished while asleep only shows how late the sleep woke up
+	if(checkLearnedDelay && busyPolls > 0 && elapsed > eeprom->writeCycleTime * 1000LL){
+		ulog(WARNING,"Write cycle took %lli us which is longer than the learned delay. Using %i us instead.", \
+							elapsed / 1000, EEPROM_WRITE_CYCLE_USEC[eeprom->model]);
+		eeprom->useLearnedDelay = 0;
+		eeprom->writeCycleTime = EEPROM_WRITE_CYCLE_USEC[eeprom->model];
+	}
+	return 0;
+}
+
+/* Send buf to every I2C EEPROM as the acknowledge poll of the write cycle left
+   pending by its last write so one write both ends a write cycle and starts the
+   next. A device does not acknowledge its I2C id while its write cycle is in
+   progress so the devices are polled round robin and each is written as soon as
+   it is done while the others are still busy. Passes where no device acknowledged
+   back off from I2C_POLL_MIN_NSEC doubling up to I2C_POLL_MAX_NSEC. An empty buf
+   only polls the devices with a pending write cycle. buf goes to the I2C id of
+   the block of addresses it is in. Returns the size of buf or -1 if a device did
+   not acknowledge */
+int writeAfterWriteCycleI2C(struct EEPROM* eeprom, char* buf, int bufSize, int block, int checkLearnedDelay){
+	int isDone[MAX_I2C_DEVICES] = {0};
+	int busyPolls[MAX_I2C_DEVICES] = {0};
+	int numDone = 0;
+	long long firstStart = 0;
+	long backoff = I2C_POLL_MIN_NSEC;
+
+	for(int i = 0; i < eeprom->numI2CDevices; i++){
+		long long start = eeprom->writeCycleStarts[i];
+		if(start == 0 && bufSize == 0){
+			isDone[i] = 1;
+			numDone++;
+		} else if(start == 0 || firstStart == -1){
+			firstStart = -1;
+		} else if(firstStart == 0 || start < firstStart){
+			firstStart = start;
+		}
+	}
+	// Sleep for most of the write cycle that started first unless a device is idle
+	if(firstStart > 0){
+		sleepWriteCycle(firstStart);
+	}
+
+	while(numDone < eeprom->numI2CDevices){
+		int numAcked = 0;
+		for(int i = 0; i < eeprom->numI2CDevices; i++){
+			if(isDone[i]){
+				continue;
+			}
+			long long start = eeprom->writeCycleStarts[i];
+			long long attempt = getTimeNSec();
+			if(writeI2C(eeprom->i2cFds[i * eeprom->numI2CBlocks + block], buf, bufSize) != -1){
+				eeprom->writeCycleStarts[i] = bufSize > eeprom->addressSize ? getTimeNSec() : 0;
+				if(start != 0){
+					recordPolledWriteCycle(eeprom, start, attempt, busyPolls[i], checkLearnedDelay);
+				}
+				isDone[i] = 1;
+				numDone++;
+				numAcked++;
+			} else if(start == 0){
+				ulog(WARNING,"I2C device 0x%02x did not acknowledge", eeprom->i2cId + i * eeprom->numI2CBlocks + block);
+				return -1;
+			} else if(attempt > start + eeprom->writeTimeout * 1000000LL){
+				eeprom->writeCycleStarts[i] = 0;
+				return recordPolledWriteCycle(eeprom, start, attempt, -1, 0);
+			} else {
+				busyPolls[i]++;
+			}
+		}
+		if(numAcked == 0){
+			delayNSec(backoff);
+			backoff = backoff * 2 < I2C_POLL_MAX_NSEC ? backoff * 2 : I2C_POLL_MAX_NSEC;
+		} else {
+			backoff = I2C_POLL_MIN_NSEC;
+		}
+	}
+	return bufSize;
+}
+
+/* Wait for the write cycles left pending by the last I2C writes to finish */
+int flushWriteCycle(struct EEPROM* eeprom){
+	if(eeprom->type != I2C){
+		return 0;
+	}
+	return writeAfterWriteCycleI2C(eeprom, NULL, 0, 0, 0) == -1 ? -1 : 0;
+}
+
 /* Poll device or wait until write cycle finishes */
 int finishWriteCycle(struct EEPROM* eeprom, struct GPIO_CONFIG* gpioConfig, int dataToCheck){
+	int checkLearnedDelay = eeprom->useLearnedDelay && ++eeprom->delayedCycles % LEARNED_DELAY_CHECK_INTERVAL == 0;
+	// I2C write cycles start as their page is written and are polled by the next I2C operation
+	if(eeprom->type == I2C && eeprom->useWriteCyclePolling && !checkLearnedDelay){
+		return 0;
+	} else if(eeprom->type == I2C && checkLearnedDelay){
+		return writeAfterWriteCycleI2C(eeprom, NULL, 0, 0, 1) == -1 ? -1 : 0;
+	}
 	// Finish Write Cycle
-	if(eeprom->useWriteCyclePolling){
-		struct timespec start;
-		struct timespec stop;
-		// Dummy write to wait for Ack from write
-		clock_gettime(CLOCK_REALTIME, &start);
-		if (eeprom->type == I2C){
-			do {
-				clock_gettime(CLOCK_REALTIME, &stop);
-			} while(writeI2C(eeprom->fd, NULL, 0) == -1 && ((stop.tv_sec - start.tv_sec) < 5));
+	if(eeprom->useWriteCyclePolling || checkLearnedDelay){
+		long long start = getTimeNSec();
+		long long deadline = start + eeprom->writeTimeout * 1000000LL;
+		int busyPolls = 0;
+		// Sleep for most of the expected write cycle and only poll for the tail.
+		// RDY/BUSY already sleeps and has to see the start of the write cycle
+		if(eeprom->pollingMethod != READY_BUSY_POLLING || eeprom->readyBusyPin == -1){
+			sleepWriteCycle(start);
+		}
+		if(eeprom->pollingMethod == READY_BUSY_POLLING && eeprom->readyBusyPin != -1){
+			busyPolls = waitReadyBusy(eeprom, gpioConfig, dataToCheck, deadline);
+		} else if(eeprom->pollingMethod == TOGGLE_BIT_POLLING){
+			busyPolls = pollToggleBit(eeprom, gpioConfig, deadline);
 		} else {
-			setPinMode(gpioConfig, eeprom->dataPins[7], INPUT);
-			setPinLevel(gpioConfig, eeprom->outputEnablePin, LOW);
-			clock_gettime(CLOCK_REALTIME, &start);
-			do {
-				clock_gettime(CLOCK_REALTIME, &stop);
-			} while((getPinLevel(gpioConfig, eeprom->dataPins[7]) ^ (dataToCheck >> 7)) && ((stop.tv_sec - start.tv_sec) < 5));
+			busyPolls = pollDataBit(eeprom, gpioConfig, dataToCheck, deadline);
 		}
-		return 0;
+		return recordPolledWriteCycle(eeprom, start, getTimeNSec(), busyPolls, checkLearnedDelay);
 	} else {
-		// Wait Write Cycle time as per datasheet
-		usleep(eeprom->writeCycleTime);
+		// Wait Write Cycle time as per datasheet. It covers every I2C write cycle. A parallel
+		// page only starts its write cycle once tBLC passes after the last byte. A learned
+		// delay is timed from the last byte so it already covers tBLC
+		long delay = eeprom->writeCycleTime * 1000L;
+		if(eeprom->type == PARALLEL && eeprom->usePageWrite && !eeprom->useLearnedDelay){
+			delay += BYTE_LOAD_CYCLE_NSEC;
+		}
+		delayNSec(delay);
+		for(int i = 0; i < eeprom->numI2CDevices; i++){
+			eeprom->writeCycleStarts[i] = 0;
+		}
 	}
 	return 0;
 }
 
-/* Writes bytes to an EEPROM via Parallel GPIO */
+/* Writes bytes to an EEPROM via Parallel GPIO. EEPROMs with page writes latch all of
+   the bytes back to back and finish a single write cycle on the last byte */
 int setBytesParallel(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* data, \
 						int addressToWrite, int numBytesToWrite){
 	int numBytesWritten = 0;
+	struct timespec pulseStart;
+	long long lastPulseEnd = 0;
+	int isLoading = 0;
+	int writePulseTime = eeprom->writePulseTime;
+	if(eeprom->dataSetupTime > writePulseTime){
+		writePulseTime = eeprom->dataSetupTime;
+	}
+	enterRealTime();
 	for(int j = 0; j < numBytesToWrite; j++){
 		ulog(TRACE,"Writing byte: %i to address: %i", data[j], addressToWrite);
-		// set the address
-		setAddressPins(gpioConfig, eeprom, addressToWrite);
-
 		// disable output from the chip
 		setPinLevel(gpioConfig, eeprom->outputEnablePin, HIGH);
 
 		// set the rpi to output on it's gpio data lines
-		for(int i = 0; i < eeprom->maxDataLength; i++){
-			setPinMode(gpioConfig, eeprom->dataPins[i], OUTPUT);
-		}
+		setDataPinsMode(gpioConfig, eeprom, OUTPUT);
 
-		// Set the data eeprom to the data to be written
-		setDataPins(gpioConfig, eeprom, data[j]);
+		// set the address and the data to be written
+		setAddressAndDataPins(gpioConfig, eeprom, addressToWrite, data[j]);
+		delayNSec(eeprom->addressSetupTime);
 		
-		// perform the write
+		// perform the write. Data is already set so the pulse covers the data setup time
 		setPinLevel(gpioConfig, eeprom->writeEnablePin, LOW);
-		usleep(1);
+		int missedLoadWindow = isLoading && getTimeNSec() - lastPulseEnd > BYTE_LOAD_WINDOW_NSEC;
+		if(isRealTime()){
+			clock_gettime(CLOCK_MONOTONIC, &pulseStart);
+		}
+		delayNSec(writePulseTime);
+		lastPulseEnd = getTimeNSec();
 		setPinLevel(gpioConfig, eeprom->writeEnablePin, HIGH);
-		
-		finishWriteCycle(eeprom, gpioConfig, data[j]);
+		if(isRealTime()){
+			checkOverrunRealTime(&pulseStart, BYTE_LOAD_CYCLE_NSEC);
+		}
+
+		if(missedLoadWindow){
+			// The page load may have ended before this byte so it is unknown whether
+			// it was latched. Wait out the write cycle and load the byte again
+			ulog(DEBUG,"Byte load window missed. Reloading from address: %i", addressToWrite);
+			delayNSec(eeprom->writeCycleTime * 1000L + BYTE_LOAD_CYCLE_NSEC);
+			isLoading = 0;
+			j--;
+			continue;
+		}
+
+		if(eeprom->usePageWrite && j != numBytesToWrite-1){
+			isLoading = 1;
+		} else {
+			isLoading = 0;
+			// A write cycle that never finished leaves the EEPROM in an unknown state
+			if(finishWriteCycle(eeprom, gpioConfig, data[j]) == -1){
+				exitRealTime();
+				return -1;
+			}
+		}
 		++addressToWrite;
 		++numBytesWritten;
 	}
+	exitRealTime();
 	return numBytesWritten;
 }
 
@@ -166,26 +577,53 @@ int setByteParallel(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, int a
 int getBytesParallel(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* buf, \
 						int addressToRead, int numBytesToRead){
 	int numBytesRead = 0;
+	enterRealTime();
+	// set the rpi to input on it's gpio data lines once for the whole run
+	setDataPinsMode(gpioConfig, eeprom, INPUT);
+	// enable output from the chip
+	setPinLevel(gpioConfig, eeprom->outputEnablePin, LOW);
+	delayNSec(eeprom->outputEnableTime);
 	for(int j = 0; j < numBytesToRead; j++){
-		int byteVal = 0;
 		ulog(TRACE,"Comparing byte: %i to address: %i", buf[j], addressToRead);
 		// set the address
 		setAddressPins(gpioConfig, eeprom, addressToRead);
-		// enable output from the chip
-		setPinLevel(gpioConfig, eeprom->outputEnablePin, LOW);
-		// set the rpi to input on it's gpio data lines
-		for(int i=0;i<eeprom->maxDataLength;i++){
-			setPinMode(gpioConfig, eeprom->dataPins[i], INPUT);
-		}
+		delayNSec(eeprom->addressAccessTime);
 		// read the eeprom and store to string
-		for(int i = eeprom->maxDataLength-1; i >= 0; i--){
-			byteVal <<= 1;
-			byteVal |= (getPinLevel(gpioConfig, eeprom->dataPins[i]) & 1);		
-		}
-		buf[j] = byteVal;
+		buf[j] = getDataPins(gpioConfig, eeprom);
 		++addressToRead;
 		++numBytesRead;
 	}
+	exitRealTime();
+	return numBytesRead;
+}
+
+/* Reads bytes from an EEPROM via Parallel GPIO visiting the addresses in Gray code order
+   so only one address pin changes between reads. Bytes are stored in address order */
+int getBytesParallelGrayCode(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* buf, \
+						int addressToRead, int numBytesToRead){
+	int numBytesRead = 0;
+	int spanBits = 0;
+
+	// Find the smallest aligned power of two span that holds every address
+	while((addressToRead >> spanBits) != ((addressToRead + numBytesToRead - 1) >> spanBits)){
+		spanBits++;
+	}
+	int base = (addressToRead >> spanBits) << spanBits;
+
+	enterRealTime();
+	setDataPinsMode(gpioConfig, eeprom, INPUT);
+	setPinLevel(gpioConfig, eeprom->outputEnablePin, LOW);
+	delayNSec(eeprom->outputEnableTime);
+	for(int i = 0; i < (1 << spanBits) && numBytesRead < numBytesToRead; i++){
+		int address = base | (i ^ (i >> 1));
+		if(address >= addressToRead && address < addressToRead + numBytesToRead){
+			setAddressPins(gpioConfig, eeprom, address);
+			delayNSec(eeprom->addressAccessTime);
+			buf[address - addressToRead] = getDataPins(gpioConfig, eeprom);
+			++numBytesRead;
+		}
+	}
+	exitRealTime();
 	return numBytesRead;
 }
 
@@ -196,7 +634,8 @@ int getByteParallel(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, int a
 	return *buf;
 }
 
-/* Populates the array for the I2C format */
+/* Populates the array for the I2C format. Address bits above the address bytes
+   select the block and are sent in the I2C id instead */
 void setAddressinBuffer(struct EEPROM* eeprom, int address, char* buf){
 	int i = eeprom->addressSize-1;
 
@@ -206,16 +645,44 @@ void setAddressinBuffer(struct EEPROM* eeprom, int address, char* buf){
         address >>= 8;	// i is 1 at first so we shift 8 bits each pass for each byte of the address
     }
 
-    if(address != 0){
+    if(address >= eeprom->numI2CBlocks){
         ulog(WARNING,"Address out of Range for EEPROM: %i", address);
     }
 }
 
-/* Reads bytes from an EEPROM via I2C */
+/* Gets the block of an address. It is the offset of the I2C id the address is read or written through */
+int getBlockI2C(struct EEPROM* eeprom, int address){
+	return (address >> (8 * eeprom->addressSize)) % eeprom->numI2CBlocks;
+}
+
+/* Reads bytes from an EEPROM via I2C. Write protection does not affect reads so
+   the WP pin is left as it is */
 int getBytesI2C(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* buf, int addressToRead, int numBytesToRead){
-    setAddressinBuffer(eeprom, addressToRead, buf);
-	setPinLevel(gpioConfig, eeprom->writeProtectPin, HIGH);
-	return readI2C(eeprom->fd, buf, numBytesToRead, eeprom->addressSize);
+	int blockSize = 1 << (8 * eeprom->addressSize);
+	int numBytesRead = 0;
+
+	if(flushWriteCycle(eeprom) == -1){
+		return -1;
+	}
+	// Each block is read through its own I2C id so reads are split where the block changes.
+	// Each transaction takes a single read message so longer reads are split too
+	while(numBytesRead < numBytesToRead){
+		int address = addressToRead + numBytesRead;
+		int numBytes = blockSize - (address % blockSize);
+		if(numBytes > MAX_I2C_READ_LEN){
+			numBytes = MAX_I2C_READ_LEN;
+		}
+		if(numBytes > numBytesToRead - numBytesRead){
+			numBytes = numBytesToRead - numBytesRead;
+		}
+		int fd = eeprom->i2cFds[eeprom->i2cReadDevice * eeprom->numI2CBlocks + getBlockI2C(eeprom, address)];
+		setAddressinBuffer(eeprom, address, buf + numBytesRead);
+		if(readI2C(fd, buf + numBytesRead, numBytes, eeprom->addressSize) == -1){
+			return -1;
+		}
+		numBytesRead += numBytes;
+	}
+	return numBytesRead;
 }
 
 /* Read a single byte from and EEPROM via I2C */
@@ -225,42 +692,34 @@ int getByteI2C(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, int addres
 	return *buf;
 }
 
-/* Writes bytes to an EEPROM via I2C */
+/* Writes bytes to an EEPROM via I2C. data must have eeprom->addressSize bytes of
+   headroom in front of it for the address so the page is sent without a copy */
 int setBytesI2C(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* data, int addressToWrite, int numBytesToWrite){
-	int bufSize = eeprom->addressSize + numBytesToWrite;
-	char buf[bufSize];
+	char* buf = data - eeprom->addressSize;
 	
 	// Disable Write Protection
-	setPinLevel(gpioConfig, eeprom->writeProtectPin, LOW);
+	if(!eeprom->isWriteProtectDisabled){
+		setPinLevel(gpioConfig, eeprom->writeProtectPin, LOW);
+		eeprom->isWriteProtectDisabled = 1;
+	}
 
 	// Set the Address
 	setAddressinBuffer(eeprom, addressToWrite, buf);
 
-	// Set the Data
-	for(int i = 0; i < numBytesToWrite && i+eeprom->addressSize < bufSize;i++){
-		buf[eeprom->addressSize+i] = data[i];
+	// Write the page to every device once its last write cycle finishes
+	int numBytesWritten = writeAfterWriteCycleI2C(eeprom, buf, eeprom->addressSize + numBytesToWrite, \
+																		getBlockI2C(eeprom, addressToWrite), 0);
+	if(numBytesWritten != -1){
+		finishWriteCycle(eeprom, NULL, 0);
 	}
-
-	// Do the write
-	int numBytesWritten = writeI2C(eeprom->fd, buf, bufSize);
-	finishWriteCycle(eeprom, NULL, 0);
 	return numBytesWritten;
 }
 
 /* Write a single byte to an EEPROM via I2C */
 int setByteI2C(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, int addressToWrite, char data){
-	return setBytesI2C(gpioConfig, eeprom, &data, addressToWrite, 1);
-}
-
-/* Fast forward to start value when reading file and return the size*/
-int setupFileToRead(FILE *romFile, int startValue){
-	fseek(romFile, 0L, SEEK_END);
-	unsigned long size = ftell(romFile);
-	rewind(romFile);
-	if(size > startValue){
-		fseek(romFile, startValue, SEEK_SET);
-	}
-	return size;
+	char buf[eeprom->addressSize + 1];
+	buf[eeprom->addressSize] = data;
+	return setBytesI2C(gpioConfig, eeprom, buf + eeprom->addressSize, addressToWrite, 1);
 }
 
 /* Get the next set of Data from a text file formatted rom */
@@ -287,23 +746,58 @@ int getNextFromTextFile(struct EEPROM *eeprom, FILE *romFile){
 /* Sets all parameters for the EEPROM to be used */
 void setEEPROMParameters(struct OPTIONS* options, struct EEPROM* eeprom){
 	eeprom->model = options->eepromModel;
+	eeprom->i2cBus = options->i2cBuses[0];
 	eeprom->i2cId = options->i2cId;
 	eeprom->forceWrite = options->force;
 	eeprom->validateWrite = options->validateWrite;
+	eeprom->eraseFirst = options->eraseFirst;
+	eeprom->eraseByte = options->eraseByte;
+	memset(eeprom->erasedPages, 0, sizeof(eeprom->erasedPages));
+	eeprom->erasedByte = 0;
 	eeprom->startValue = options->startValue;
 	eeprom->fileType = options->fileType;
 
 	eeprom->byteWriteCounter = 0;
 	eeprom->byteReadCounter = 0;
 
+	eeprom->addressBus.isRequested = 0;
+	eeprom->dataBus.isRequested = 0;
+	eeprom->controlBus.isRequested = 0;
+	eeprom->lastAddress = -1;
+
 	eeprom->useWriteCyclePolling = options->useWriteCyclePolling;
+	if(options->pollingMethod == -1){
+		eeprom->pollingMethod = EEPROM_POLLING_METHOD[options->eepromModel];
+	} else {
+		eeprom->pollingMethod = options->pollingMethod;
+	}
+	eeprom->readyBusyPin = -1;
+	eeprom->isWriteProtectDisabled = 0;
+	eeprom->profileFile = NULL;
+	eeprom->useLearnedDelay = 0;
+	eeprom->delayedCycles = 0;
+	for(int i = 0; i < MAX_I2C_DEVICES; i++){
+		eeprom->writeCycleStarts[i] = 0;
+	}
+	if(options->writeTimeoutMSec == -1 || options->writeTimeoutMSec == 0){
+		eeprom->writeTimeout = DEFAULT_WRITE_TIMEOUT_MSEC;
+	} else {
+		eeprom->writeTimeout = options->writeTimeoutMSec;
+	}
 	
 	eeprom->size = EEPROM_MODEL_SIZE[eeprom->model];
 	eeprom->maxAddressLength = EEPROM_ADDRESS_LENGTH[eeprom->model];
 	eeprom->maxDataLength = (EEPROM_DATA_LENGTH[eeprom->model]);
 	eeprom->pageSize = EEPROM_PAGE_SIZE[eeprom->model];
+	eeprom->usePageWrite = EEPROM_PAGE_WRITE[eeprom->model];
 	eeprom->addressSize = EEPROM_ADDRESS_SIZE[eeprom->model];
+	eeprom->addressSetupTime = EEPROM_ADDRESS_SETUP_NSEC[eeprom->model];
+	eeprom->writePulseTime = EEPROM_WRITE_PULSE_NSEC[eeprom->model];
+	eeprom->dataSetupTime = EEPROM_DATA_SETUP_NSEC[eeprom->model];
+	eeprom->outputEnableTime = EEPROM_OUTPUT_ENABLE_NSEC[eeprom->model];
+	eeprom->addressAccessTime = EEPROM_ADDRESS_ACCESS_NSEC[eeprom->model];
 	eeprom->quick = options->quick;
+	eeprom->useGrayCode = options->useGrayCode;
 	if( options->readChunk == -1 || options->readChunk == 0){
 		eeprom->readChunk = eeprom->pageSize;
 	} else {
@@ -322,12 +816,39 @@ void setEEPROMParameters(struct OPTIONS* options, struct EEPROM* eeprom){
     	eeprom->limit = options->limit;
 	}
 
-	if (eeprom->model >= AT24C01 && eeprom->model <= AT24C512){
+	if (eeprom->model >= AT24C01 && eeprom->model <= AT24CM02){
 		eeprom->type = I2C;
 	} else {
 		eeprom->type = PARALLEL;
 	}
 
+	// Gray code order only helps parallel EEPROMs and is best over the whole chip.
+	// I2C reads the whole range in one transaction up to a block
+	eeprom->numI2CDevices = 1;
+	eeprom->numI2CBlocks = EEPROM_I2C_BLOCKS[eeprom->model];
+	eeprom->i2cReadDevice = 0;
+	if(eeprom->type == I2C){
+		eeprom->useGrayCode = 0;
+		// Devices written together may hold different data so they are not read first
+		eeprom->numI2CDevices = options->numI2CDevices;
+		if(eeprom->numI2CDevices > 1){
+			eeprom->forceWrite = 1;
+		}
+		if(options->readChunk == -1 || options->readChunk == 0){
+			eeprom->readChunk = eeprom->size < MAX_I2C_READ_CHUNK ? eeprom->size : MAX_I2C_READ_CHUNK;
+		} else if(eeprom->readChunk > MAX_I2C_READ_CHUNK){
+			ulog(WARNING,"Read Chunk set above maximum: %i. Setting to %i.", MAX_I2C_READ_CHUNK, MAX_I2C_READ_CHUNK);
+			eeprom->readChunk = MAX_I2C_READ_CHUNK;
+		}
+	} else if(eeprom->useGrayCode && (options->readChunk == -1 || options->readChunk == 0)){
+		eeprom->readChunk = eeprom->size;
+	} else if(eeprom->readChunk > MAX_PARALLEL_READ_CHUNK){
+		ulog(WARNING,"Read Chunk set above maximum: %i. Setting to %i.", MAX_PARALLEL_READ_CHUNK, MAX_PARALLEL_READ_CHUNK);
+		eeprom->readChunk = MAX_PARALLEL_READ_CHUNK;
+	}
+	if(eeprom->type == PARALLEL && options->numI2CBuses > 1){
+		ulog(WARNING,"I2C buses are ignored for parallel EEPROMs");
+	}
 }
 
 /* Sets all parameters to use GPIO */
@@ -356,11 +877,19 @@ int initHardware(struct OPTIONS *options, struct EEPROM *eeprom, struct GPIO_CON
 	setEEPROMParameters(options, eeprom);
 	ulog(DEBUG,"Starting GPIO Initialization");
 	setGPIOConfigParameters(options, gpioConfig);
+	if(setBackendGPIO(options->gpioBackend)){
+		return -1;
+	}
+	if(options->useRealTime && setupRealTime(options->realTimeCPU)){
+		ulog(ERROR, "Failed to setup real-time mode");
+		return -1;
+	}
 	if(setupGPIO(&gpioConfig->gpioChip)){
 		ulog(ERROR, "Failed to setup GPIO");
+		cleanupRealTime();
 		return -1;
 	}
-	if (eeprom->model >= AT24C01 && eeprom->model <= AT24C512){
+	if (eeprom->model >= AT24C01 && eeprom->model <= AT24CM02){
 								// 2; // 8 // 3 // I2C Pins 
 								// 3; // 9 // 5 // I2C Pins
 
@@ -372,24 +901,44 @@ int initHardware(struct OPTIONS *options, struct EEPROM *eeprom, struct GPIO_CON
 		eeprom->writeProtectPin = 16; // 27 // 36
 
 
-		for(int i=0;i<3;i++){
-			setPinMode(gpioConfig,eeprom->addressPins[i], OUTPUT);
-			setPinLevel(gpioConfig,eeprom->addressPins[i], LOW);
+		int numI2CIds = eeprom->numI2CDevices * eeprom->numI2CBlocks;
+		if(eeprom->i2cId < 0x50 || eeprom->i2cId + numI2CIds - 1 > 0x57){
+			ulog(ERROR,"I2C ids 0x%02x through 0x%02x are not all EEPROM ids", \
+												eeprom->i2cId, eeprom->i2cId + numI2CIds - 1);
+			cleanupGPIO(&gpioConfig->gpioChip);
+			cleanupRealTime();
+			return -1;
+		}
+		// The low bits of the I2C id of the AT24CM01 and AT24CM02 are address bits
+		if((eeprom->i2cId - 0x50) % eeprom->numI2CBlocks){
+			ulog(ERROR,"I2C id of the %s must be 0x50 plus a multiple of %i", \
+												EEPROM_MODEL_STRINGS[eeprom->model], eeprom->numI2CBlocks);
+			cleanupGPIO(&gpioConfig->gpioChip);
+			cleanupRealTime();
+			return -1;
 		}
 
-		if (eeprom->i2cId != 0x50){
-			setAddressPins(gpioConfig, eeprom, eeprom->i2cId - 0x50);
+		// A0-A2 select the I2C id of the device
+		for(int i=0;i<3;i++){
+			setPinMode(gpioConfig,eeprom->addressPins[i], OUTPUT);
+			setPinLevel(gpioConfig,eeprom->addressPins[i], ((eeprom->i2cId - 0x50) >> i) & 1);
 		}
 
 		setPinMode(gpioConfig,eeprom->writeProtectPin, OUTPUT);
 		setPinMode(gpioConfig,eeprom->vccPin, OUTPUT);
 		setPinLevel(gpioConfig,eeprom->writeProtectPin, HIGH);
 		setPinLevel(gpioConfig,eeprom->vccPin, HIGH);
+		eeprom->isWriteProtectDisabled = 0;
+
+		if(options->gpioBackend == SIM && connectEEPROMSim(eeprom)){
+			cleanupGPIO(&gpioConfig->gpioChip);
+			cleanupRealTime();
+			return -1;
+		}
 
-		eeprom->fd = setupI2C(eeprom->i2cId);
-		if(eeprom->fd == -1){
-			ulog(ERROR,"Cannot setup I2C device");
+		if(openI2CDevices(eeprom)){
 			cleanupGPIO(&gpioConfig->gpioChip);
+			cleanupRealTime();
 			return -1;
 		}
 
@@ -413,6 +962,10 @@ int initHardware(struct OPTIONS *options, struct EEPROM *eeprom, struct GPIO_CON
 		
 		if (eeprom->model == AT28C64 || eeprom->model == AT28C256){
 			eeprom->writeEnablePin =  14; // 15 // 8
+			if (eeprom->model == AT28C64){
+				// Pin 1 of the AT28C64 is RDY/BUSY instead of A14
+				eeprom->readyBusyPin = eeprom->addressPins[14];
+			}
 			
 			eeprom->addressPins[13] = 15; // 16 // 10
 			eeprom->addressPins[11] = 24; // 5 // 18
@@ -452,13 +1005,101 @@ int initHardware(struct OPTIONS *options, struct EEPROM *eeprom, struct GPIO_CON
 		setPinLevel(gpioConfig,eeprom->chipEnablePin, LOW);
 		setPinLevel(gpioConfig,eeprom->outputEnablePin, HIGH);
 		setPinLevel(gpioConfig,eeprom->writeEnablePin, HIGH);
+
+		requestBusPins(gpioConfig, eeprom);
+
+		if(options->gpioBackend == SIM && connectEEPROMSim(eeprom)){
+			cleanupGPIO(&gpioConfig->gpioChip);
+			cleanupRealTime();
+			return -1;
+		}
+
+		if(eeprom->pollingMethod == READY_BUSY_POLLING){
+			if(eeprom->readyBusyPin == -1){
+				eeprom->pollingMethod = EEPROM_POLLING_METHOD[eeprom->model];
+				ulog(WARNING,"%s has no RDY/BUSY pin. Using %s polling instead.", \
+								EEPROM_MODEL_STRINGS[eeprom->model], POLLING_METHOD_STRINGS[eeprom->pollingMethod]);
+			} else if(requestEventsGPIO(&gpioConfig->gpioChip, eeprom->readyBusyPin)){
+				ulog(INFO,"No edge events on RDY/BUSY. Polling its level instead.");
+			}
+		}
 	}
 
-	usleep(5000); //startup delay
+	// Leave room in the histogram for write cycles that run past the datasheet
+	setupWriteCycle(EEPROM_WRITE_CYCLE_USEC[eeprom->model] * 2000LL);
+	if(options->useProfile && options->profileFile != NULL){
+		eeprom->profileFile = options->profileFile;
+	} else if(options->useProfile && options->gpioBackend != SIM){
+		// Simulated write cycles would spoil the profile of a real chip
+		eeprom->profileFile = getDefaultProfileWriteCycle();
+	}
+	if(eeprom->profileFile != NULL){
+		loadProfileWriteCycle(eeprom->profileFile, EEPROM_MODEL_STRINGS[eeprom->model]);
+	}
+	// Only a delay that was not given is learned. It is never longer than the datasheet's
+	if(!eeprom->useWriteCyclePolling && (options->writeCycleUSec == -1 || options->writeCycleUSec == 0)){
+		long long learnedDelay = getLearnedDelayWriteCycle();
+		if(learnedDelay > 0 && learnedDelay < eeprom->writeCycleTime * 1000LL){
+			eeprom->writeCycleTime = (learnedDelay + 999) / 1000;
+			eeprom->useLearnedDelay = 1;
+			ulog(INFO,"Using learned write cycle delay of %i us",eeprom->writeCycleTime);
+		} else if(learnedDelay > 0){
+			ulog(WARNING,"Learned write cycle delay of %lli us is not shorter than the datasheet's %i us. Using the datasheet's.", \
+								(learnedDelay + 999) / 1000, eeprom->writeCycleTime);
+		}
+	}
+	calibrateDelay();
+	delayNSec(EEPROM_POWER_UP_USEC[eeprom->model] * 1000L);
 	ulog(DEBUG,"Finished GPIO Initialization");
 	return 0;
 }
 
+/* Whether the page of address was left erased by an erase in this session */
+int isPageErased(struct EEPROM* eeprom, int address){
+	int page = address / eeprom->pageSize;
+	if(address < 0 || page >= MAX_ERASED_PAGES){
+		return 0;
+	}
+	return (eeprom->erasedPages[page / 8] >> (page % 8)) & 1;
+}
+
+/* Marks the pages that are wholly inside startAddress up to endAddress as erased with
+   eraseByte. Pages erased with another byte are forgotten */
+void markErasedPages(struct EEPROM* eeprom, int startAddress, int endAddress, char eraseByte){
+	if(eraseByte != eeprom->erasedByte){
+		memset(eeprom->erasedPages, 0, sizeof(eeprom->erasedPages));
+		eeprom->erasedByte = eraseByte;
+	}
+	int firstPage = (startAddress + eeprom->pageSize - 1) / eeprom->pageSize;
+	for(int page = firstPage; (page + 1) * eeprom->pageSize <= endAddress && page < MAX_ERASED_PAGES; page++){
+		eeprom->erasedPages[page / 8] |= 1 << (page % 8);
+	}
+}
+
+/* Forgets that the pages written from address on are erased */
+void clearErasedPages(struct EEPROM* eeprom, int address, int numBytes){
+	for(int i = address - address % eeprom->pageSize; i < address + numBytes; i += eeprom->pageSize){
+		int page = i / eeprom->pageSize;
+		if(i >= 0 && page < MAX_ERASED_PAGES){
+			eeprom->erasedPages[page / 8] &= ~(1 << (page % 8));
+		}
+	}
+}
+
+/* Whether every byte of data is the erased byte and the page it goes to is known to be
+   erased so it does not need to be written. data must not cross a page */
+int isErasedData(struct EEPROM* eeprom, char* data, int address, int numBytes){
+	if(!isPageErased(eeprom, address)){
+		return 0;
+	}
+	for(int i = 0; i < numBytes; i++){
+		if(data[i] != eeprom->erasedByte){
+			return 0;
+		}
+	}
+	return 1;
+}
+
 /* Read specified number of bytes starting from specified Address */
 int readNumBytesFromAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* byteBuffer, \
 																				int addressToRead, int numBytesToRead){
@@ -478,8 +1119,9 @@ int readNumBytesFromAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eepro
 		numBytesToRead = eeprom->limit - addressToRead ;
 	}
 
+	// Sequential I2C reads do not stop at page boundaries so only parallel reads are aligned
 	int maxBytesToRead = eeprom->readChunk - (addressToRead % eeprom->readChunk);
-	if(maxBytesToRead < numBytesToRead){
+	if(eeprom->type == PARALLEL && maxBytesToRead < numBytesToRead){
 		numBytesToRead = maxBytesToRead;
 		ulog(DEBUG,"Addresses requested crosses page boundary. Only reading %i bytes", numBytesToRead);
 	}
@@ -489,6 +1131,11 @@ int readNumBytesFromAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eepro
 		if(numBytesRead != -1){
 			eeprom->byteReadCounter += numBytesRead;
 		}
+	} else if(eeprom->useGrayCode){
+		numBytesRead = getBytesParallelGrayCode(gpioConfig, eeprom, byteBuffer, addressToRead, numBytesToRead);
+		if(numBytesRead != -1){
+			eeprom->byteReadCounter += numBytesRead;
+		}
 	} else {
 		numBytesRead = getBytesParallel(gpioConfig, eeprom, byteBuffer, addressToRead, numBytesToRead);
 		if(numBytesRead != -1){
@@ -518,7 +1165,8 @@ int readByteFromAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, i
 	return byteVal;
 }
 
-/* Write specified number of bytes starting from specified Address */
+/* Write specified number of bytes starting from specified Address. byteBuffer must
+   have eeprom->addressSize bytes of headroom in front of it for I2C EEPROMs */
 int writeNumBytesToAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* byteBuffer, \
 																				int addressToWrite, int numBytesToWrite){
 	int numBytesWritten = 0;
@@ -543,6 +1191,7 @@ int writeNumBytesToAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom
 		ulog(DEBUG,"Addresses requested crosses page boundary. Only writing %i bytes", numBytesToWrite);
 	}
 
+	clearErasedPages(eeprom, addressToWrite, numBytesToWrite);
 	if (eeprom->type == I2C){
 		numBytesWritten = setBytesI2C(gpioConfig, eeprom, byteBuffer, addressToWrite, numBytesToWrite);
 	} else {
@@ -555,12 +1204,23 @@ int writeNumBytesToAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom
 	}
 	if(numBytesWritten-eeprom->addressSize != numBytesToWrite){
 		ulog(ERROR,"Cannot write %i bytes starting at address: %i", numBytesToWrite, addressToWrite);
-		numBytesWritten = -1;
+		return -1;
 	}
 
 	return numBytesWritten - eeprom->addressSize;
 }
 
+/* Write bytes that sit inside a larger buffer like writeNumBytesToAddress. The bytes
+   in front of them are borrowed for the address of I2C EEPROMs and put back after */
+int writeNumBytesInPlace(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* byteBuffer, \
+																				int addressToWrite, int numBytesToWrite){
+	char savedBytes[eeprom->addressSize + 1];
+	memcpy(savedBytes, byteBuffer - eeprom->addressSize, eeprom->addressSize);
+	int numBytesWritten = writeNumBytesToAddress(gpioConfig, eeprom, byteBuffer, addressToWrite, numBytesToWrite);
+	memcpy(byteBuffer - eeprom->addressSize, savedBytes, eeprom->addressSize);
+	return numBytesWritten;
+}
+
 /* Write specified byte to specified address */
 int writeByteToAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, int addressToWrite, char dataToWrite){
 	int err = 0;
@@ -570,8 +1230,18 @@ int writeByteToAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, in
 		return -1;
 	}
 
+	// A byte of an erased page is known without reading it
+	int isErased = isPageErased(eeprom, addressToWrite);
+	if(isErased && dataToWrite == eeprom->erasedByte){
+		return 0;
+	}
+	int isWritten = eeprom->forceWrite || isErased || dataToWrite != readByteFromAddress(gpioConfig, eeprom, addressToWrite);
+	if(isWritten){
+		clearErasedPages(eeprom, addressToWrite, 1);
+	}
+
 	if (eeprom->type == I2C){
-		if (eeprom->forceWrite || dataToWrite != readByteFromAddress(gpioConfig, eeprom, addressToWrite)){
+		if (isWritten){
 			if (setByteI2C(gpioConfig, eeprom, addressToWrite, dataToWrite) != -1){
 				ulog(DEBUG,"Wrote Byte %i at Address %i", dataToWrite, addressToWrite);
 				eeprom->byteWriteCounter++;
@@ -581,9 +1251,11 @@ int writeByteToAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, in
 			}
 		}
 	} else {
-		if (eeprom->forceWrite || dataToWrite != readByteFromAddress(gpioConfig, eeprom, addressToWrite)){
-			setByteParallel(gpioConfig ,eeprom, addressToWrite, dataToWrite);
-			if (eeprom->validateWrite == 1){
+		if (isWritten){
+			if (setByteParallel(gpioConfig ,eeprom, addressToWrite, dataToWrite) == -1){
+				ulog(WARNING,"Failed to Write Byte %i at Address %i", dataToWrite, addressToWrite);
+				err = -1;
+			} else if (eeprom->validateWrite == 1){
 				if (dataToWrite != readByteFromAddress(gpioConfig, eeprom, addressToWrite)){
 					ulog(WARNING,"Failed to Write Byte %i at Address %i", dataToWrite, addressToWrite);
 					err = -1;
@@ -610,7 +1282,7 @@ int writeTextFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM *eeprom,
 		ulog(ERROR,"Quick action, -q or --quick, not valid for text files");
 		err = -1;
 	} else {
-		while(addressToWrite < eeprom->limit && addressToWrite != -1 && dataToWrite != -1){
+		while(addressToWrite < eeprom->limit && addressToWrite != -1 && dataToWrite != -1 && err != -1){
 			addressToWrite = getNextFromTextFile(eeprom, romFile);
 			dataToWrite = getNextFromTextFile(eeprom, romFile);
 			
@@ -660,33 +1332,200 @@ int compareTextFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM *eepro
 	return bytesNotMatched;
 }
 
-/* Open and write a binary file to the EEPROM */
-int writeBinaryFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, FILE *romFile){
-	int dataToWrite;
+/* A run of bytes written to the EEPROM with a single write */
+struct WRITE_RUN{
+	int address;
+	int numBytes;
+};
+
+/* Estimated time to write numBytes within one page with a single write */
+long long getWriteCostNSec(struct EEPROM* eeprom, int numBytes){
+	long long byteNSec = PLAN_I2C_BYTE_NSEC;
+	if(eeprom->type == PARALLEL){
+		byteNSec = eeprom->addressSetupTime + eeprom->writePulseTime;
+		if(eeprom->dataSetupTime > eeprom->writePulseTime){
+			byteNSec = eeprom->addressSetupTime + eeprom->dataSetupTime;
+		}
+	}
+	int numWriteCycles = eeprom->usePageWrite ? 1 : numBytes;
+	return numWriteCycles * eeprom->writeCycleTime * 1000LL + (eeprom->addressSize + numBytes) * byteNSec;
+}
+
+/* Groups the bytes of fileBuf that differ from eepromBuf into runs that never cross
+   a page. The unchanged bytes between two changes in a page are written again when
+   that is cheaper than another write. Returns the number of runs */
+int planWriteRuns(struct EEPROM* eeprom, char* fileBuf, char* eepromBuf, int windowStart, \
+																	int numBytes, struct WRITE_RUN* runs){
+	int numRuns = 0;
+	for(int i = 0; i < numBytes; i++){
+		if(fileBuf[i] == eepromBuf[i]){
+			continue;
+		}
+		int address = windowStart + i;
+		if(numRuns > 0){
+			struct WRITE_RUN* run = &runs[numRuns-1];
+			int numMergedBytes = address - run->address + 1;
+			if(run->address / eeprom->pageSize == address / eeprom->pageSize && \
+					getWriteCostNSec(eeprom, numMergedBytes) <= \
+					getWriteCostNSec(eeprom, run->numBytes) + getWriteCostNSec(eeprom, 1)){
+				run->numBytes = numMergedBytes;
+				continue;
+			}
+		}
+		runs[numRuns].address = address;
+		runs[numRuns].numBytes = 1;
+		numRuns++;
+	}
+	return numRuns;
+}
+
+/* Read numBytesToRead starting from address in as many reads as it takes. byteBuffer
+   must have eeprom->addressSize bytes of room after the bytes for I2C EEPROMs */
+int readRangeFromAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* byteBuffer, \
+																				int addressToRead, int numBytesToRead){
+	int numBytesRead = 0;
+	while(numBytesRead < numBytesToRead){
+		int bytesRead = readNumBytesFromAddress(gpioConfig, eeprom, byteBuffer + numBytesRead, \
+											addressToRead + numBytesRead, numBytesToRead - numBytesRead);
+		if(bytesRead <= 0){
+			return -1;
+		}
+		numBytesRead += bytesRead;
+	}
+	return numBytesRead;
+}
+
+/* Read numBytes starting from address like readRangeFromAddress except for the pages
+   known to be erased which are filled with the erased byte without reading them */
+int readUnknownPagesFromAddress(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char* byteBuffer, \
+																				int addressToRead, int numBytesToRead){
+	int offset = 0;
+	while(offset < numBytesToRead){
+		int isErased = isPageErased(eeprom, addressToRead + offset);
+		int numBytes = 0;
+		// Take pages up to the next one that is known or unknown
+		do {
+			int address = addressToRead + offset + numBytes;
+			numBytes += eeprom->pageSize - address % eeprom->pageSize;
+		} while(offset + numBytes < numBytesToRead && \
+						isPageErased(eeprom, addressToRead + offset + numBytes) == isErased);
+		if(numBytes > numBytesToRead - offset){
+			numBytes = numBytesToRead - offset;
+		}
+		if(isErased){
+			memset(byteBuffer + offset, eeprom->erasedByte, numBytes);
+		} else if(readRangeFromAddress(gpioConfig, eeprom, byteBuffer + offset, addressToRead + offset, numBytes) == -1){
+			return -1;
+		}
+		offset += numBytes;
+	}
+	return numBytesToRead;
+}
+
+/* Write the bytes of image, or fillByte to every address if image is NULL, from the
+   start value up to endAddress. Each window of the EEPROM is read once and only the runs
+   of bytes that differ are written. Runs are written from where they are except from a
+   mapped image which has no room in front of it for the address of I2C EEPROMs */
+int writeChangedBytesToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, struct IMAGE* image, \
+																		int endAddress, char fillByte){
+	char fillBuf[eeprom->addressSize + PLAN_WINDOW_SIZE];
+	char* fileBuf = fillBuf + eeprom->addressSize;
+	char eepromBuf[PLAN_WINDOW_SIZE + eeprom->addressSize];
+	char pageBuf[eeprom->addressSize + eeprom->pageSize];
+	struct WRITE_RUN runs[PLAN_WINDOW_SIZE];
+	int numBytesChanged = 0;
+	int numBytesPlanned = 0;
+	int numRunsPlanned = 0;
+	int err = 0;
+
+	if(image == NULL){
+		memset(fileBuf, fillByte, PLAN_WINDOW_SIZE);
+	}
+	for(int windowStart = eeprom->startValue; windowStart < endAddress && err != -1;){
+		int numBytes = (windowStart / PLAN_WINDOW_SIZE + 1) * PLAN_WINDOW_SIZE - windowStart;
+		if(numBytes > endAddress - windowStart){
+			numBytes = endAddress - windowStart;
+		}
+		if(image != NULL){
+			numBytes = getImageBytes(image, windowStart, numBytes, &fileBuf);
+			if(numBytes == 0){
+				break;
+			}
+		}
+		if(numBytes == -1 || readUnknownPagesFromAddress(gpioConfig, eeprom, eepromBuf, windowStart, numBytes) == -1){
+			err = -1;
+			break;
+		}
+
+		int numRuns = planWriteRuns(eeprom, fileBuf, eepromBuf, windowStart, numBytes, runs);
+		for(int i = 0; i < numBytes; i++){
+			numBytesChanged += fileBuf[i] != eepromBuf[i];
+		}
+
+		for(int i = 0; i < numRuns && err != -1; i++){
+			int offset = runs[i].address - windowStart;
+			char* runBuf = fileBuf + offset;
+			if(eeprom->addressSize && image != NULL && image->isMapped){
+				memcpy(pageBuf + eeprom->addressSize, runBuf, runs[i].numBytes);
+				runBuf = pageBuf + eeprom->addressSize;
+			}
+			if(writeNumBytesInPlace(gpioConfig, eeprom, runBuf, runs[i].address, runs[i].numBytes) == -1){
+				err = -1;
+			} else if(eeprom->type == PARALLEL && eeprom->validateWrite == 1){
+				if(readRangeFromAddress(gpioConfig, eeprom, eepromBuf + offset, runs[i].address, \
+																		runs[i].numBytes) == -1 || \
+										memcmp(eepromBuf + offset, fileBuf + offset, runs[i].numBytes)){
+					ulog(WARNING,"Failed to Write %i Bytes at Address %i", runs[i].numBytes, runs[i].address);
+					err = -1;
+				}
+			}
+			if(err != -1){
+				ulog(DEBUG,"Wrote %i bytes at Address %i", runs[i].numBytes, runs[i].address);
+			}
+			numBytesPlanned += runs[i].numBytes;
+		}
+		numRunsPlanned += numRuns;
+		windowStart += numBytes;
+	}
+
+	ulog(INFO,"Wrote %i changed bytes in %i writes of %i bytes", numBytesChanged, numRunsPlanned, numBytesPlanned);
+	return err;
+}
+
+/* Write a binary image to the EEPROM */
+int writeBinaryFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, struct IMAGE* image){
 	int addressToWrite = eeprom->startValue;
 	int err = 0;
-	unsigned int fileSize = setupFileToRead(romFile, eeprom->startValue);
+	char* bytesToWrite;
+	int numBytes = 0;
 	
 	if(eeprom->quick){
-		int numBytesToWrite = eeprom->pageSize;
-		if(eeprom->limit-eeprom->startValue < eeprom->pageSize){
-			numBytesToWrite = eeprom->limit-eeprom->startValue;
-		}
-		int bytesWritten = numBytesToWrite;
-		char bytesToWriteBuf[numBytesToWrite];
+		// The address of I2C EEPROMs is put in front of the pages of a mapped image here
+		char pageBuf[eeprom->addressSize + eeprom->pageSize];
 
-		while(addressToWrite < eeprom->limit && err != -1 && addressToWrite < fileSize){
-			int i = 0;
-
-			while(bytesWritten < numBytesToWrite){
-				bytesToWriteBuf[i++] = bytesToWriteBuf[bytesWritten++];
+		while(addressToWrite < eeprom->limit && err != -1){
+			// Pages are taken from the image a page at a time
+			numBytes = eeprom->pageSize - addressToWrite % eeprom->pageSize;
+			if(numBytes > eeprom->limit - addressToWrite){
+				numBytes = eeprom->limit - addressToWrite;
+			}
+			numBytes = getImageBytes(image, addressToWrite, numBytes, &bytesToWrite);
+			if(numBytes <= 0){
+				err = numBytes;
+				break;
 			}
 
-			while((i < numBytesToWrite && addressToWrite+i < eeprom->limit && (dataToWrite = fgetc(romFile)) != EOF)) {
-				bytesToWriteBuf[i++] = (char)dataToWrite;
+			// Pages known to be erased are skipped where the file only has the erased byte
+			if(isErasedData(eeprom, bytesToWrite, addressToWrite, numBytes)){
+				addressToWrite += numBytes;
+				continue;
 			}
 
-			bytesWritten = writeNumBytesToAddress(gpioConfig, eeprom, bytesToWriteBuf, addressToWrite, i);
+			if(eeprom->addressSize && image->isMapped){
+				memcpy(pageBuf + eeprom->addressSize, bytesToWrite, numBytes);
+				bytesToWrite = pageBuf + eeprom->addressSize;
+			}
+			int bytesWritten = writeNumBytesInPlace(gpioConfig, eeprom, bytesToWrite, addressToWrite, numBytes);
 			if( bytesWritten != -1){
 				ulog(DEBUG,"Wrote %i bytes",bytesWritten);
 				addressToWrite += bytesWritten;
@@ -694,88 +1533,167 @@ int writeBinaryFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eepro
 				err = -1;
 			}
 		}
+	} else if(!eeprom->forceWrite){
+		err = writeChangedBytesToEEPROM(gpioConfig, eeprom, image, eeprom->limit, 0);
 	} else {
-		while((addressToWrite < eeprom->limit && addressToWrite < fileSize && (dataToWrite = fgetc(romFile)) != EOF)) {
-			err |= writeByteToAddress(gpioConfig, eeprom, addressToWrite++, (char)dataToWrite);
+		// The image is taken a page at a time so a pipe is written as it is read
+		while(addressToWrite < eeprom->limit && \
+				(numBytes = getImageBytes(image, addressToWrite, eeprom->pageSize, &bytesToWrite)) > 0){
+			if(numBytes > eeprom->limit - addressToWrite){
+				numBytes = eeprom->limit - addressToWrite;
+			}
+			for(int i = 0; i < numBytes && err != -1; i++){
+				err = writeByteToAddress(gpioConfig, eeprom, addressToWrite++, bytesToWrite[i]);
+			}
+			if(err == -1){
+				break;
+			}
+		}
+		if(numBytes == -1){
+			err = -1;
 		}
 	}
 
 	return err;
 }
 
-/* Compare a binary file to EEPROM */
-int compareBinaryFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, FILE *romFile){
-	int dataToCompare;
+/* Compare a binary image to EEPROM. Every I2C EEPROM written together is compared
+   to each part of the image in turn so the image is only read once */
+int compareBinaryFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, struct IMAGE* image){
 	int addressToCompare = eeprom->startValue;
 	int bytesNotMatched = 0;
-	unsigned int fileSize = setupFileToRead(romFile, eeprom->startValue);
+	char* bytesFromFile;
+	int numBytes = 0;
 
 	if(eeprom->quick){
-		int numBytesToCompare = eeprom->readChunk;
-		if(eeprom->limit - eeprom->startValue < eeprom->readChunk){
-			numBytesToCompare = eeprom->limit - eeprom->startValue;
-		}
-		int bytesRead = numBytesToCompare;
-		char bytesToCompareBuf[numBytesToCompare+eeprom->addressSize];
-		char bytesFromFileBuf[numBytesToCompare+eeprom->addressSize];
+		char bytesToCompareBuf[eeprom->readChunk + eeprom->addressSize];
 		
-		while(addressToCompare < eeprom->limit && bytesNotMatched != -1 && addressToCompare < fileSize){
-			int i = 0;
-
-			while(bytesRead < numBytesToCompare){
-				bytesFromFileBuf[i++] = bytesFromFileBuf[bytesRead++];
+		while(addressToCompare < eeprom->limit && bytesNotMatched != -1){
+			numBytes = eeprom->readChunk;
+			if(numBytes > eeprom->limit - addressToCompare){
+				numBytes = eeprom->limit - addressToCompare;
 			}
-
-			while((i < numBytesToCompare && addressToCompare+i < fileSize && \
-					addressToCompare+i < eeprom->limit && (dataToCompare = fgetc(romFile)) != EOF)) {
-				bytesFromFileBuf[i++] = (char)dataToCompare;
+			numBytes = getImageBytes(image, addressToCompare, numBytes, &bytesFromFile);
+			if(numBytes <= 0){
+				bytesNotMatched = numBytes == -1 ? -1 : bytesNotMatched;
+				break;
 			}
 
-			bytesRead = readNumBytesFromAddress(gpioConfig, eeprom, bytesToCompareBuf, addressToCompare, i);
-			if( bytesRead != -1){
-				for(int i = 0;i < bytesRead; i++){
-					if(bytesFromFileBuf[i] != bytesToCompareBuf[i]){
-						ulog(INFO,"Byte at Address 0x%02x does not match. EEPROM: %i File: %i", \
-															addressToCompare+i, bytesToCompareBuf[i], bytesFromFileBuf[i]);
-						bytesNotMatched++;
+			int bytesRead = 0;
+			for(int device = 0; device < eeprom->numI2CDevices && bytesNotMatched != -1; device++){
+				eeprom->i2cReadDevice = device;
+				bytesRead = readNumBytesFromAddress(gpioConfig, eeprom, bytesToCompareBuf, addressToCompare, numBytes);
+				if(bytesRead == -1){
+					bytesNotMatched = -1;
+				} else if(memcmp(bytesFromFile, bytesToCompareBuf, bytesRead)){
+					for(int i = 0;i < bytesRead; i++){
+						if(bytesFromFile[i] != bytesToCompareBuf[i]){
+							ulog(INFO,"Byte at Address 0x%02x does not match. EEPROM: %i File: %i", \
+															addressToCompare+i, bytesToCompareBuf[i], bytesFromFile[i]);
+							bytesNotMatched++;
+						}
 					}
 				}
-				addressToCompare += bytesRead;
-			} else{
-				bytesNotMatched = -1;
 			}
+			addressToCompare += bytesRead;
 		}
 	} else {
-		while(((dataToCompare = fgetc(romFile)) != EOF) && addressToCompare < fileSize && addressToCompare < eeprom->limit) {
-			char byte = readByteFromAddress(gpioConfig, eeprom, addressToCompare);
-			if (byte != (char)dataToCompare){
-				ulog(INFO,"Byte at Address 0x%02x does not match. EEPROM: %i File: %i", \
-															addressToCompare, byte, (char)dataToCompare);
-				bytesNotMatched++;
+		// The image is taken a page at a time so a pipe is compared as it is read
+		while(addressToCompare < eeprom->limit && \
+				(numBytes = getImageBytes(image, addressToCompare, eeprom->pageSize, &bytesFromFile)) > 0){
+			if(numBytes > eeprom->limit - addressToCompare){
+				numBytes = eeprom->limit - addressToCompare;
 			}
-			addressToCompare++;
+			for(int i = 0; i < numBytes; i++){
+				for(int device = 0; device < eeprom->numI2CDevices; device++){
+					eeprom->i2cReadDevice = device;
+					char byte = readByteFromAddress(gpioConfig, eeprom, addressToCompare);
+					if (byte != bytesFromFile[i]){
+						ulog(INFO,"Byte at Address 0x%02x does not match. EEPROM: %i File: %i", \
+																	addressToCompare, byte, bytesFromFile[i]);
+						bytesNotMatched++;
+					}
+				}
+				addressToCompare++;
+			}
+		}
+		if(numBytes == -1){
+			bytesNotMatched = -1;
 		}
 	}
+	eeprom->i2cReadDevice = 0;
 
 	return bytesNotMatched;
 }
 
 /* Compare a file to EEPROM */
 int compareFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, FILE *romFile){
-	if (eeprom->fileType == TEXT_FILE){
-		return compareTextFileToEEPROM(gpioConfig, eeprom, romFile);
-	} else {
-		return compareBinaryFileToEEPROM(gpioConfig, eeprom, romFile);
+	int bytesNotMatched = 0;
+	if (eeprom->fileType != TEXT_FILE){
+		struct IMAGE image;
+		if(openImage(romFile, &image) == -1){
+			return -1;
+		}
+		bytesNotMatched = compareBinaryFileToEEPROM(gpioConfig, eeprom, &image);
+		closeImage(&image);
+		return bytesNotMatched;
 	}
+	// Every I2C EEPROM written together is compared in turn
+	for(int i = 0; i < eeprom->numI2CDevices && bytesNotMatched != -1; i++){
+		int deviceBytesNotMatched;
+		eeprom->i2cReadDevice = i;
+		if(i > 0 && fseek(romFile, 0L, SEEK_SET) == -1){
+			ulog(ERROR,"Unable to compare a piped text file to more than one I2C device");
+			bytesNotMatched = -1;
+			break;
+		}
+		deviceBytesNotMatched = compareTextFileToEEPROM(gpioConfig, eeprom, romFile);
+		if(deviceBytesNotMatched == -1){
+			bytesNotMatched = -1;
+		} else {
+			bytesNotMatched += deviceBytesNotMatched;
+		}
+	}
+	eeprom->i2cReadDevice = 0;
+	return bytesNotMatched;
 }
 
 /* Open and write a file to EEPROM */
 int writeFileToEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, FILE *romFile){
+	int err = 0;
+	if(eeprom->eraseFirst){
+		// The erase is read back so the write knows which pages are left erased. Devices
+		// written together are not read back
+		int quick = eeprom->quick;
+		int forceWrite = eeprom->forceWrite;
+		if(eeprom->numI2CDevices == 1){
+			eeprom->quick = 0;
+			eeprom->forceWrite = 0;
+		}
+		err = eraseEEPROM(gpioConfig, eeprom, eeprom->eraseByte);
+		eeprom->quick = quick;
+		eeprom->forceWrite = forceWrite;
+		if(err == -1){
+			ulog(ERROR,"Unable to erase the EEPROM before writing");
+			return -1;
+		}
+	}
 	if (eeprom->fileType == TEXT_FILE){
-		return writeTextFileToEEPROM(gpioConfig, eeprom, romFile);
+		err = writeTextFileToEEPROM(gpioConfig, eeprom, romFile);
 	} else {
-		return writeBinaryFileToEEPROM(gpioConfig, eeprom, romFile);
+		struct IMAGE image;
+		if(openImage(romFile, &image) == -1){
+			err = -1;
+		} else {
+			err = writeBinaryFileToEEPROM(gpioConfig, eeprom, &image);
+			closeImage(&image);
+		}
+	}
+	// The last write cycle is not done until it is acknowledged
+	if(flushWriteCycle(eeprom) == -1){
+		err = -1;
 	}
+	return err;
 }
 
 /* Prints the EEPROM's Contents to the specified limit */
@@ -1105,6 +2023,48 @@ int printEEPROMContents(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, i
 	return err;
 }
 
+/* Erases every byte of the EEPROM to 0xFF with the JEDEC software chip erase sequence.
+   The bytes of the sequence are latched back to back like a page so each one is within
+   tBLC of the last. Returns 0 once the chip erase finishes or -1 if it did not */
+int eraseChipParallel(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom){
+	const int commandAddresses[] = {0x5555, 0x2AAA, 0x5555, 0x5555, 0x2AAA, 0x5555};
+	const char commandData[] = {0xAA, 0x55, 0x80, 0xAA, 0x55, 0x10};
+	long long lastPulseEnd = 0;
+	int missedLoadWindow = 0;
+	int writePulseTime = eeprom->writePulseTime;
+	if(eeprom->dataSetupTime > writePulseTime){
+		writePulseTime = eeprom->dataSetupTime;
+	}
+
+	enterRealTime();
+	for(int i = 0; i < 6 && !missedLoadWindow; i++){
+		setPinLevel(gpioConfig, eeprom->outputEnablePin, HIGH);
+		setDataPinsMode(gpioConfig, eeprom, OUTPUT);
+		setAddressAndDataPins(gpioConfig, eeprom, commandAddresses[i], commandData[i]);
+		delayNSec(eeprom->addressSetupTime);
+		setPinLevel(gpioConfig, eeprom->writeEnablePin, LOW);
+		missedLoadWindow = i > 0 && getTimeNSec() - lastPulseEnd > BYTE_LOAD_WINDOW_NSEC;
+		delayNSec(writePulseTime);
+		lastPulseEnd = getTimeNSec();
+		setPinLevel(gpioConfig, eeprom->writeEnablePin, HIGH);
+	}
+	exitRealTime();
+
+	// An interrupted sequence writes the bytes latched so far like a page instead
+	long long start = getTimeNSec();
+	delayNSec(missedLoadWindow ? eeprom->writeCycleTime * 1000L : EEPROM_CHIP_ERASE_USEC[eeprom->model] * 1000L);
+	if(pollToggleBit(eeprom, gpioConfig, start + eeprom->writeTimeout * 1000000LL) == -1){
+		ulog(WARNING,"Chip erase did not finish within %i ms",eeprom->writeTimeout);
+		return -1;
+	}
+	if(missedLoadWindow){
+		ulog(WARNING,"Chip erase sequence was interrupted");
+		return -1;
+	}
+	ulog(INFO,"Chip erase finished in %lli us", (getTimeNSec() - start) / 1000);
+	return 0;
+}
+
 /* Erase EEPROM */
 int eraseEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char eraseByte){
 	int err = 0;
@@ -1115,7 +2075,27 @@ int eraseEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char eras
 		return -1;
 	}
 
-	if(eeprom->quick){
+	// Only a chip erase of the whole EEPROM to 0xFF can be done at once
+	int useChipErase = eeprom->type == PARALLEL && EEPROM_CHIP_ERASE_USEC[eeprom->model] > 0 && \
+						(unsigned char)eraseByte == 0xFF && eeprom->startValue == 0 && eeprom->limit >= eeprom->size;
+	if(useChipErase){
+		if(eraseChipParallel(gpioConfig, eeprom) != -1){
+			eeprom->byteWriteCounter += eeprom->size;
+		} else {
+			ulog(WARNING,"Chip erase failed. Erasing page by page instead.");
+		}
+	}
+
+	if(useChipErase || (!eeprom->quick && !eeprom->forceWrite && eeprom->startValue >= 0)){
+		// Pages that are already erased are skipped. After a chip erase this only verifies it
+		int endAddress = eeprom->limit < eeprom->size ? eeprom->limit : eeprom->size;
+		err = writeChangedBytesToEEPROM(gpioConfig, eeprom, NULL, endAddress, eraseByte);
+		// Every page has been read back or written with the erase byte so later writes
+		// in this session do not need to read or write the bytes that are still erased
+		if(err != -1 && (eeprom->type == I2C || eeprom->validateWrite == 1)){
+			markErasedPages(eeprom, eeprom->startValue, endAddress, eraseByte);
+		}
+	} else if(eeprom->quick){
 		// Check to see if paging is supported
 		if(eeprom->pageSize < 0){
 			ulog(ERROR,"EEPROM does not support paging. Remove -q or --quick flag.");
@@ -1130,12 +2110,13 @@ int eraseEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char eras
 		if(eeprom->limit - eeprom->startValue < eeprom->pageSize){
 			numBytesToWrite = eeprom->limit - eeprom->startValue;
 		}
-		char bytesToWriteBuf[numBytesToWrite + eeprom->addressSize];
-		memset(bytesToWriteBuf, eraseByte, numBytesToWrite + eeprom->addressSize);
+		char pageBuf[numBytesToWrite + eeprom->addressSize];
+		memset(pageBuf, eraseByte, numBytesToWrite + eeprom->addressSize);
 		
 		// Perform the erase
 		while(addressToWrite < eeprom->limit && err != -1){
-			int bytesWritten = writeNumBytesToAddress(gpioConfig, eeprom, bytesToWriteBuf, addressToWrite, numBytesToWrite);
+			int bytesWritten = writeNumBytesToAddress(gpioConfig, eeprom, pageBuf + eeprom->addressSize, \
+																		addressToWrite, numBytesToWrite);
 			if( bytesWritten != -1){
 				addressToWrite += bytesWritten;
 			} else {
@@ -1144,17 +2125,52 @@ int eraseEEPROM(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom, char eras
 		}
 	} else {
 		// Perform the erase
-		for(int i = eeprom->startValue; i < eeprom->limit; i++) {
-			err |= writeByteToAddress(gpioConfig, eeprom, i, eraseByte);
+		for(int i = eeprom->startValue; i < eeprom->limit && err != -1; i++) {
+			err = writeByteToAddress(gpioConfig, eeprom, i, eraseByte);
 		}
 	}
+	if(flushWriteCycle(eeprom) == -1){
+		err = -1;
+	}
 	return err;
 }
 
+/* Opens each I2C EEPROM on the bus. Only the A0-A2 pins of the first device are
+   driven so every other device has its A0-A2 pins strapped to its own id */
+int openI2CDevices(struct EEPROM* eeprom){
+	for(int i = 0; i < eeprom->numI2CDevices * eeprom->numI2CBlocks; i++){
+		eeprom->i2cFds[i] = setupI2C(eeprom->i2cBus, eeprom->i2cId + i);
+		if(eeprom->i2cFds[i] == -1){
+			ulog(ERROR,"Cannot setup I2C device 0x%02x on bus %i", eeprom->i2cId + i, eeprom->i2cBus);
+			while(i-- > 0){
+				cleanupI2C(eeprom->i2cFds[i]);
+			}
+			return -1;
+		}
+		eeprom->writeCycleStarts[i / eeprom->numI2CBlocks] = 0;
+	}
+	return 0;
+}
+
+/* Closes each I2C EEPROM on the bus */
+void closeI2CDevices(struct EEPROM* eeprom){
+	for(int i = 0; i < eeprom->numI2CDevices * eeprom->numI2CBlocks; i++){
+		cleanupI2C(eeprom->i2cFds[i]);
+	}
+}
+
 /* Free and release hardware */
 void cleanupHardware(struct GPIO_CONFIG* gpioConfig, struct EEPROM* eeprom){
+	flushWriteCycle(eeprom);
 	cleanupGPIO(&gpioConfig->gpioChip);
-	cleanupI2C(eeprom->fd);
+	if(eeprom->type == I2C){
+		closeI2CDevices(eeprom);
+	}
+	cleanupRealTime();
+	if(eeprom->profileFile != NULL){
+		saveProfileWriteCycle(eeprom->profileFile, EEPROM_MODEL_STRINGS[eeprom->model]);
+	}
+	reportWriteCycle();
 }
 
 /******************************************************************************
@@ -1191,23 +2207,50 @@ void printHelp(){
 	fprintf(stdout,"Usage: piepro [options]\n");
 	fprintf(stdout,"Options:\n");
 	fprintf(stdout," -c FILE,   --compare FILE  Compare FILE and EEPROM and print number of differences.\n");
+	fprintf(stdout,"                            FILE may be - or a pipe to read it as it is written.\n");
 	fprintf(stdout,"            --chipname      Specify the chipname to use. Default: gpiochip0\n");
 	fprintf(stdout," -d [N],    --dump [N]      Dump the contents of the EEPROM\n");
 	fprintf(stdout,"                            0=PRETTY_WITH_ASCII, 1=BINARY, 2=TEXT, 3=LABELED, 4=PRETTY. Default: PRETTY_WITH_ASCII\n");
 	fprintf(stdout," -e [N],    --erase [N]     Erase eeprom with specified byte. Default: 0xFF\n");
+	fprintf(stdout,"                            The AT28C256 is erased to 0xFF with a chip erase. Otherwise\n");
+	fprintf(stdout,"                            only the pages that are not already erased are written unless forced.\n");
+	fprintf(stdout,"            --erase-first   Erase the EEPROM with 0xFF before writing. Pages the erase leaves erased\n");
+	fprintf(stdout,"                            are not read or written again where the file only has 0xFF.\n");
 	fprintf(stdout," -f,        --force         Force writing of every byte instead of checking for existing value first.\n");
+	fprintf(stdout,"                            Without it binary files are read once and only the changed bytes are\n");
+	fprintf(stdout,"                            written, a page at a time where the EEPROM has page writes.\n");
+	fprintf(stdout,"            --gpio-backend BACKEND\n");
+	fprintf(stdout,"                            Backend used to drive the GPIO. libgpiod, gpiomem or sim. Default: libgpiod\n");
+	fprintf(stdout,"            --gray-code     Visit addresses in Gray code order for quick reads of parallel EEPROMs.\n");
+	fprintf(stdout,"                            Reads the whole range at once unless a read chunk is given with -q N.\n");
+	fprintf(stdout,"            --i2c-bus N[,N...]\n");
+	fprintf(stdout,"                            I2C bus /dev/i2c-N of the EEPROM. With several buses the EEPROMs on\n");
+	fprintf(stdout,"                            every bus are written, compared or erased at once. Default: 1\n");
 	fprintf(stdout," -id,       --i2c-device-id The address id of the I2C device.\n");
+	fprintf(stdout,"                            The AT24CM01 and AT24CM02 also use the ids above it for their\n");
+	fprintf(stdout,"                            high address bits.\n");
+	fprintf(stdout,"            --i2c-devices N Write N I2C EEPROMs at once at consecutive ids from the I2C id.\n");
+	fprintf(stdout,"                            Pages are written to each while the others finish their write cycle.\n");
+	fprintf(stdout,"                            Implied --force. Compares check every device. Default: 1\n");
 	fprintf(stdout," -h,        --help          Print this message and exit.\n");
 	fprintf(stdout," -l N,      --limit N       Specify the maximum address to operate.\n");
 	fprintf(stdout," -m MODEL,  --model MODEL   Specify EERPOM device model. Default: AT28C16.\n");
 	fprintf(stdout,"            --no-validate-write \n");
 	fprintf(stdout,"                            Do not perform a read directly after writing to verify the data was written.\n");
+	fprintf(stdout,"            --polling METHOD\n");
+	fprintf(stdout,"                            Detect the end of parallel write cycles with data or toggle bit polling\n");
+	fprintf(stdout,"                            or by waiting on the RDY/BUSY pin of the AT28C64.\n");
+	fprintf(stdout,"                            data, toggle or ready. Default: depends on the EEPROM model\n");
 	fprintf(stdout," -r [N],    --read [N]      Read the contents of the EEPROM\n");
 	fprintf(stdout,"                            0=PRETTY_WITH_ASCII, 1=BINARY, 2=TEXT, 3=LABELED, 4=PRETTY. Default: PRETTY_WITH_ASCII\n");
+	fprintf(stdout,"            --realtime [CPU]\n");
+	fprintf(stdout,"                            Lock memory, pin to CPU and use SCHED_FIFO during bus operations.\n");
+	fprintf(stdout,"                            Overruns are reported at exit. Default CPU: last online CPU\n");
 	fprintf(stdout," -rb N,     --read-byte ADDRESS\n"); 
 	fprintf(stdout,"                            Read From specified ADDRESS.\n"); 
 	fprintf(stdout," -q [N],     --quick [N]    Operates on N bytes at once for reads. Page Size if unspecified or writes.\n");
 	fprintf(stdout,"                            Implied --force and --no-validate-write.\n");
+	fprintf(stdout,"                            I2C reads up to 64 KB at once unless N is given.\n");
 	fprintf(stdout," -rb N,     --read-byte ADDRESS \n");
 	fprintf(stdout,"                            Read From specified ADDRESS.\n");
 	fprintf(stdout," -s N,      --start N       Specify the minimum address to operate.\n");
@@ -1217,9 +2260,17 @@ void printHelp(){
 	fprintf(stdout," -v N,      --v[vvvv]       Set the log verbosity to N, 0=OFF, 1=FATAL, 2=ERROR, 3=WARNING, 4=INFO, 5=DEBUG 6=TRACE. Default: WARNING\n");
 	fprintf(stdout,"            --version       Print the piepro version and exit.\n");
 	fprintf(stdout," -w FILE,   --write FILE    Write EEPROM with specified file.\n");
+	fprintf(stdout,"                            FILE may be - or a pipe to write it as it is read. Needs --yes for -.\n");
 	fprintf(stdout," -wb ADDRESS DATA, --write-byte ADDRESS DATA \n");
 	fprintf(stdout,"                            Write specified DATA to ADDRESS.\n");
 	fprintf(stdout," -wd [N],   --write-delay N Enable write delay. N Number of microseconds to delay between writes.\n");
+	fprintf(stdout,"            --write-profile FILE\n");
+	fprintf(stdout,"                            Keep the write cycle times of each model in FILE. A write delay without N\n");
+	fprintf(stdout,"                            uses the learned times. Default: ~/.cache/piepro/write-cycles\n");
+	fprintf(stdout,"            --no-write-profile\n");
+	fprintf(stdout,"                            Do not load or save write cycle times.\n");
+	fprintf(stdout,"            --write-timeout MSEC\n");
+	fprintf(stdout,"                            Give up waiting for a polled write cycle after MSEC milliseconds. Default: 5000\n");
 	fprintf(stdout," -y,        --yes           Automatically answer Yes to write or erase EEPROM.\n");
 	fprintf(stdout,"\n");
 	fprintf(stdout,"\n");
@@ -1235,14 +2286,20 @@ void setDefaultOptions(struct OPTIONS* options){
     options->dumpFormat = PRETTY_WITH_ASCII;
     options->validateWrite = 1;
     options->force = 0;
+    options->eraseFirst = 0;
     options->action = NOTHING;
     options->fileType = BINARY_FILE;
     options->eepromModel = END;
     options->writeCycleUSec = -1;
 	options->useWriteCyclePolling = 1;
+	options->pollingMethod = -1;
+	options->writeTimeoutMSec = -1;
+	options->useProfile = 1;
+	options->profileFile = NULL;
 	options->boardType = RPI4;
 	options->eraseByte = 0xFF;
 	options->quick = 0;
+	options->useGrayCode = 0;
 	options->readChunk = -1;
 	options->promptUser = 1;
 	// Single Read/Write Parameters
@@ -1250,9 +2307,47 @@ void setDefaultOptions(struct OPTIONS* options){
     options->dataParam = 0;
 	// I2C Specific
 	options->i2cId = 0x50;
+	options->numI2CDevices = 1;
+	options->i2cBuses[0] = DEFAULT_I2C_BUS;
+	options->numI2CBuses = 1;
 	options->consumer = consumer;
     options->chipname = chipname;
     options->numGPIOLines = 28;
+	options->gpioBackend = LIBGPIOD;
+	// Real-Time
+	options->useRealTime = 0;
+	options->realTimeCPU = -1;
+}
+
+/* Parses a comma separated list of I2C bus numbers */
+int parseI2CBuses(struct OPTIONS* options, char* busList){
+	char buses[strlen(busList) + 1];
+	strcpy(buses, busList);
+	options->numI2CBuses = 0;
+	for(char* bus = strtok(buses, ","); bus != NULL; bus = strtok(NULL, ",")){
+		if(options->numI2CBuses == MAX_I2C_BUSES){
+			ulog(ERROR,"No more than %i I2C buses can be used at once", MAX_I2C_BUSES);
+			return -1;
+		}
+		int busNum = str2num(bus);
+		if(busNum < 0){
+			ulog(ERROR,"Unsupported I2C bus value: %s", bus);
+			return -1;
+		}
+		for(int i = 0; i < options->numI2CBuses; i++){
+			if(options->i2cBuses[i] == busNum){
+				ulog(ERROR,"I2C bus %i is given more than once", busNum);
+				return -1;
+			}
+		}
+		options->i2cBuses[options->numI2CBuses++] = busNum;
+		ulog(INFO,"Using I2C bus /dev/i2c-%i",busNum);
+	}
+	if(options->numI2CBuses == 0){
+		ulog(ERROR,"No I2C bus specified");
+		return -1;
+	}
+	return 0;
 }
 
 /* Parses and processes all command line arguments */
@@ -1361,12 +2456,73 @@ int parseCommandLineOptions(struct OPTIONS* options, int argc, char* argv[]){
 				}
 			}
 
+			// --erase-first
+			if (!strcmp(argv[i], "--erase-first")){
+					ulog(INFO,"Erasing EEPROM before writing.");
+					options->eraseFirst = 1;
+			}
+
 			// -f --force
 			if (!strcmp(argv[i], "-f") || !strcmp(argv[i], "--force")){
 					ulog(INFO,"Forcing all writes even if value is already present.");
 					options->force = 1;
 			}
 
+			// --gpio-backend
+			if (!strcmp(argv[i], "--gpio-backend")){
+				if (i != argc-1) {
+					options->gpioBackend = 0;
+					while(options->gpioBackend < END_GPIO_BACKEND && strcmp(argv[i+1], GPIO_BACKEND_STRINGS[options->gpioBackend])){
+						options->gpioBackend++;
+					}
+					if(options->gpioBackend == END_GPIO_BACKEND){
+						ulog(ERROR,"Unsupported GPIO backend: %s", argv[i+1]);
+						return -1;
+					}
+					ulog(INFO,"Setting GPIO backend to %s", argv[i+1]);
+					i++;
+				} else {
+					ulog(ERROR,"%s Flag must have a backend specified", argv[i]);
+					return -1;
+				}
+			}
+
+			// --gray-code
+			if (!strcmp(argv[i], "--gray-code")){
+				ulog(INFO,"Reading in Gray code address order");
+				options->useGrayCode = 1;
+			}
+
+			// --i2c-bus
+			if (!strcmp(argv[i], "--i2c-bus")){
+				if (i != argc-1) {
+					if (parseI2CBuses(options, argv[i+1])){
+						return -1;
+					}
+					i++;
+				} else {
+					ulog(ERROR,"%s Flag must have a bus specified", argv[i]);
+					return -1;
+				}
+			}
+
+			// --i2c-devices
+			if (!strcmp(argv[i], "--i2c-devices")){
+				if (i != argc-1) {
+					options->numI2CDevices = str2num(argv[i+1]);
+					if (options->numI2CDevices < 1 || options->numI2CDevices > MAX_I2C_DEVICES){
+						ulog(ERROR,"Number of I2C devices must be 1 through %i", MAX_I2C_DEVICES);
+						return -1;
+					} else {
+						ulog(INFO,"Writing %i I2C devices",options->numI2CDevices);
+					}
+					i++;
+				} else {
+					ulog(ERROR,"%s Flag must have a number of devices specified", argv[i]);
+					return -1;
+				}
+			}
+
 			// -id --i2c-device-id
 			if (!strcmp(argv[i], "-id") || !strcmp(argv[i], "--i2c-device-id")){
 				if (i != argc-1) {
@@ -1427,6 +2583,18 @@ int parseCommandLineOptions(struct OPTIONS* options, int argc, char* argv[]){
 				options->validateWrite = 0;
 			}
 
+			// --realtime
+			if (!strcmp(argv[i], "--realtime")){
+				ulog(INFO,"Using real-time mode for bus operations");
+				options->useRealTime = 1;
+				if (i != argc-1) {
+					options->realTimeCPU = str2num(argv[i+1]);
+					if ( options->realTimeCPU != -1 ){
+						ulog(INFO,"Pinning to CPU %i", options->realTimeCPU);
+					}
+				}
+			}
+
 			// -rb --read-byte
 			if (!strcmp(argv[i], "-rb") || !strcmp(argv[i], "--read-byte")){
 				if (options->action != READ_SINGLE_BYTE_FROM_ROM && options->action != NOTHING){
@@ -1446,16 +2614,32 @@ int parseCommandLineOptions(struct OPTIONS* options, int argc, char* argv[]){
 				}
 			}
 
+			// --polling
+			if (!strcmp(argv[i], "--polling")){
+				if (i != argc-1) {
+					options->pollingMethod = 0;
+					while(options->pollingMethod < END_POLLING_METHOD && \
+											strcmp(argv[i+1], POLLING_METHOD_STRINGS[options->pollingMethod])){
+						options->pollingMethod++;
+					}
+					if(options->pollingMethod == END_POLLING_METHOD){
+						ulog(ERROR,"Unsupported polling method: %s", argv[i+1]);
+						return -1;
+					}
+					ulog(INFO,"Setting polling method to %s", argv[i+1]);
+					i++;
+				} else {
+					ulog(ERROR,"%s Flag must have a polling method specified", argv[i]);
+					return -1;
+				}
+			}
+
 			// -q --quick
 			if (!strcmp(argv[i], "-q") || !strcmp(argv[i], "--quick")){
 					ulog(INFO,"Using quick operations. Implied --force and --no-validate-write.");
 					options->quick = 1;
 					if (i != argc-1) {
 					options->readChunk = str2num(argv[i+1]);
-					if(options->readChunk > 8192){
-						ulog(WARNING,"Read Chunk set above maximum: 8192. Setting to 8192.");
-						options->readChunk = 8192;
-					}
 					if ( options->readChunk != -1 && options->readChunk != 0 ){
 						ulog(INFO,"Setting read chunk to %i", options->readChunk );
 					}
@@ -1511,6 +2695,40 @@ int parseCommandLineOptions(struct OPTIONS* options, int argc, char* argv[]){
 				}
 			}
 
+			// --write-profile
+			if (!strcmp(argv[i], "--write-profile")){
+				if (i != argc-1) {
+					options->profileFile = argv[i+1];
+					ulog(INFO,"Setting write cycle profile to %s", options->profileFile);
+					i++;
+				} else {
+					ulog(ERROR,"%s Flag must have a filename specified", argv[i]);
+					return -1;
+				}
+			}
+
+			// --no-write-profile
+			if (!strcmp(argv[i], "--no-write-profile")){
+				ulog(INFO,"Not using a write cycle profile");
+				options->useProfile = 0;
+			}
+
+			// --write-timeout
+			if (!strcmp(argv[i], "--write-timeout")){
+				if (i != argc-1) {
+					options->writeTimeoutMSec = str2num(argv[i+1]);
+					if ( options->writeTimeoutMSec == -1 || options->writeTimeoutMSec == 0){
+						ulog(ERROR,"Invalid write timeout: %s", argv[i+1]);
+						return -1;
+					}
+					ulog(INFO,"Setting write timeout to %i ms", options->writeTimeoutMSec);
+					i++;
+				} else {
+					ulog(ERROR,"%s Flag must have a timeout specified", argv[i]);
+					return -1;
+				}
+			}
+
 			// -wb --write-byte
 			if (!strcmp(argv[i], "-wb") || !strcmp(argv[i], "--write-byte")){
 				if (options->action != WRITE_SINGLE_BYTE_TO_ROM && options->action != NOTHING){
@@ -0,0 +1,150 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rt.h"
+#include "ulog.h"
+
+#define NSEC_PER_SEC 1000000000L
+
+static int isSetup = 0;
+static int depth = 0;
+static int savedPolicy = SCHED_OTHER;
+static struct sched_param savedParam;
+static long switchesAtEnter = 0;
+static struct RT_STATS rtStats;
+
+/* Returns the number of times the calling thread has been preempted */
+static long getPreemptions(){
+    struct rusage usage;
+    if(getrusage(RUSAGE_THREAD, &usage)){
+        return 0;
+    }
+    return usage.ru_nivcsw;
+}
+
+/* Locks memory, pins the thread to a CPU and checks SCHED_FIFO is allowed */
+int setupRealTime(int cpu){
+    struct sched_param param = {.sched_priority = RT_PRIORITY};
+    cpu_set_t cpuSet;
+
+    if(isSetup){
+        ulog(ERROR,"Real-time mode is already setup");
+        return -1;
+    }
+    if(cpu == -1){
+        cpu = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    }
+    if(cpu < 0 || cpu >= CPU_SETSIZE){
+        ulog(ERROR,"Invalid CPU for real-time mode: %i",cpu);
+        return -1;
+    }
+
+    // Page faults during a bus operation would stretch it just like preemption
+    if(mlockall(MCL_CURRENT | MCL_FUTURE)){
+        ulog(ERROR,"Unable to lock memory for real-time mode");
+        return -1;
+    }
+
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    if(sched_setaffinity(0, sizeof(cpuSet), &cpuSet)){
+        ulog(ERROR,"Unable to pin to CPU: %i",cpu);
+        munlockall();
+        return -1;
+    }
+
+    // Make sure SCHED_FIFO can be used now instead of failing part way through
+    savedPolicy = sched_getscheduler(0);
+    sched_getparam(0, &savedParam);
+    if(sched_setscheduler(0, SCHED_FIFO, &param)){
+        ulog(ERROR,"Unable to use SCHED_FIFO. Real-time mode needs CAP_SYS_NICE or root");
+        munlockall();
+        return -1;
+    }
+    sched_setscheduler(0, savedPolicy, &savedParam);
+
+    memset(&rtStats, 0, sizeof(rtStats));
+    depth = 0;
+    isSetup = 1;
+    ulog(INFO,"Real-time mode on CPU: %i with priority: %i",cpu,RT_PRIORITY);
+    return 0;
+}
+
+/* Raises the thread to SCHED_FIFO for the duration of a bus operation */
+int enterRealTime(){
+    struct sched_param param = {.sched_priority = RT_PRIORITY};
+
+    if(!isSetup || depth++ > 0){
+        return 0;
+    }
+    if(sched_setscheduler(0, SCHED_FIFO, &param)){
+        ulog(WARNING,"Unable to raise to SCHED_FIFO");
+        return -1;
+    }
+    rtStats.sections++;
+    switchesAtEnter = getPreemptions();
+    return 0;
+}
+
+/* Returns the thread to the policy it had before the bus operation */
+void exitRealTime(){
+    if(!isSetup || depth == 0 || --depth > 0){
+        return;
+    }
+    rtStats.preemptions += getPreemptions() - switchesAtEnter;
+    sched_setscheduler(0, savedPolicy, &savedParam);
+}
+
+/* Records an overrun if a timed section took longer than its budget */
+int checkOverrunRealTime(struct timespec* start, long budgetNSec){
+    struct timespec now;
+
+    if(!isSetup){
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long elapsed = (now.tv_sec - start->tv_sec) * NSEC_PER_SEC + (now.tv_nsec - start->tv_nsec);
+    if(elapsed <= budgetNSec){
+        return 0;
+    }
+    rtStats.overruns++;
+    if(elapsed - budgetNSec > rtStats.maxOverrunNSec){
+        rtStats.maxOverrunNSec = elapsed - budgetNSec;
+    }
+    ulog(DEBUG,"Real-time overrun of %li ns",elapsed - budgetNSec);
+    return 1;
+}
+
+/* Returns whether real-time mode is setup */
+int isRealTime(){
+    return isSetup;
+}
+
+/* Copies the real-time counters */
+void getStatsRealTime(struct RT_STATS* stats){
+    *stats = rtStats;
+}
+
+/* Reports overruns and leaves real-time mode */
+void cleanupRealTime(){
+    if(!isSetup){
+        return;
+    }
+    if(depth > 0){
+        depth = 1;
+        exitRealTime();
+    }
+    if(rtStats.overruns || rtStats.preemptions){
+        ulog(WARNING,"Real-time mode: %li overruns (max %li ns) and %li preemptions in %li bus operations", \
+                            rtStats.overruns, rtStats.maxOverrunNSec, rtStats.preemptions, rtStats.sections);
+    } else {
+        ulog(INFO,"Real-time mode: no overruns in %li bus operations",rtStats.sections);
+    }
+    munlockall();
+    isSetup = 0;
+}
@@ -0,0 +1,630 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gpio.h"
+#include "piepro.h"
+#include "sim.h"
+#include "ulog.h"
+
+#define MAX_SIM_LINES 40
+#define MAX_USABLE_SIM_LINES 34
+#define MAX_SIM_PAGE_SIZE 256
+#define MAX_SIM_I2C_DEVICES 8
+#define MAX_SIM_I2C_BUSES 8
+#define SIM_I2C_BASE_ID 0x50
+#define SIM_I2C_FD_BASE 1000
+#define BYTE_LOAD_CYCLE_USEC 150
+#define CHIP_ERASE_SEQUENCE_LENGTH 6
+
+// The JEDEC software chip erase sequence
+static const int chipEraseAddresses[CHIP_ERASE_SEQUENCE_LENGTH] = {0x5555, 0x2AAA, 0x5555, 0x5555, 0x2AAA, 0x5555};
+static const unsigned char chipEraseData[CHIP_ERASE_SEQUENCE_LENGTH] = {0xAA, 0x55, 0x80, 0xAA, 0x55, 0x10};
+
+/* A simulated EEPROM. Loaded bytes are committed to memory when the write cycle finishes */
+struct SIM_EEPROM{
+    int isPresent;
+    int model;
+    int size;
+    int pageSize;
+    int addressSize;
+    int usePageMode;
+    unsigned char* memory;
+
+    int address;
+    int pageAddress;
+    unsigned char pageBuffer[MAX_SIM_PAGE_SIZE];
+    char pageLoaded[MAX_SIM_PAGE_SIZE];
+    unsigned char lastByte;
+    int toggleBit;
+    int commandStep;
+    int isChipErasing;
+
+    int isLoading;
+    int isBusy;
+    long long loadDeadline;
+    long long busyUntil;
+};
+
+/* Pins a simulated EEPROM is wired to */
+struct SIM_WIRING{
+    int isConnected;
+    int addressPins[MAX_ADDRESS_PINS];
+    int numAddressPins;
+    int lineDataBit[MAX_SIM_LINES];
+    int chipEnablePin;
+    int outputEnablePin;
+    int writeEnablePin;
+    int writeProtectPin;
+    int readyBusyPin;
+    int lastCE;
+    int lastOE;
+    int lastWE;
+};
+
+static int lineLevels[MAX_SIM_LINES];
+static struct SIM_WIRING wiring = {.isConnected = 0, .writeProtectPin = -1, .readyBusyPin = -1};
+static struct SIM_EEPROM parallelDevice;
+static struct SIM_EEPROM i2cDevices[MAX_SIM_I2C_BUSES][MAX_SIM_I2C_DEVICES];
+// I2C buses may be driven from a thread each
+static pthread_mutex_t i2cLock = PTHREAD_MUTEX_INITIALIZER;
+static struct SIM_STATS simStats;
+static int writeCycleUSec = -1;
+// The AT28C256 typically finishes a page well within its 10 ms maximum. It is simulated
+// at this so writing all 32 KB of it a byte at a time stays quick
+#define SIM_AT28C256_WRITE_CYCLE_USEC 1000
+
+/* Current time in microseconds */
+long long getTimeSim(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+/* Allocate the memory of a device if the model changed. Erased EEPROMs read 0xFF */
+int initDeviceSim(struct SIM_EEPROM* device, int model){
+    if(!device->isPresent || device->model != model){
+        free(device->memory);
+        device->memory = malloc(EEPROM_MODEL_SIZE[model]);
+        if(device->memory == NULL){
+            ulog(ERROR,"Unable to allocate memory for simulated EEPROM");
+            device->isPresent = 0;
+            return -1;
+        }
+        memset(device->memory, 0xFF, EEPROM_MODEL_SIZE[model]);
+    }
+    device->isPresent = 1;
+    device->model = model;
+    device->size = EEPROM_MODEL_SIZE[model];
+    device->addressSize = EEPROM_ADDRESS_SIZE[model];
+    device->usePageMode = (model == AT28C64 || model == AT28C256 || (model >= AT24C01 && model <= AT24CM02));
+    device->pageSize = device->usePageMode ? EEPROM_PAGE_SIZE[model] : 1;
+    device->address = 0;
+    device->isLoading = 0;
+    device->isBusy = 0;
+    device->commandStep = 0;
+    device->isChipErasing = 0;
+    memset(device->pageLoaded, 0, sizeof(device->pageLoaded));
+    return 0;
+}
+
+/* Stop loading bytes and start the internal write cycle */
+void startWriteCycleSim(struct SIM_EEPROM* device, long long start){
+    device->isLoading = 0;
+    device->isBusy = 1;
+    int usec = writeCycleUSec;
+    if(usec == -1){
+        usec = device->model == AT28C256 ? SIM_AT28C256_WRITE_CYCLE_USEC : EEPROM_WRITE_CYCLE_USEC[device->model];
+    }
+    device->busyUntil = start + usec;
+    simStats.writeCycles++;
+}
+
+/* Advance a device to the current time */
+void updateDeviceSim(struct SIM_EEPROM* device, long long now){
+    if(device->isLoading && now >= device->loadDeadline){
+        startWriteCycleSim(device, device->loadDeadline);
+    }
+    if(device->isBusy && now >= device->busyUntil && device->isChipErasing){
+        memset(device->memory, 0xFF, device->size);
+        device->isChipErasing = 0;
+        device->isBusy = 0;
+    }
+    if(device->isBusy && now >= device->busyUntil){
+        for(int i = 0; i < device->pageSize; i++){
+            if(device->pageLoaded[i]){
+                device->memory[device->pageAddress + i] = device->pageBuffer[i];
+                device->pageLoaded[i] = 0;
+            }
+        }
+        device->isBusy = 0;
+    }
+}
+
+/* Load a byte into the page buffer of a device */
+void loadByteSim(struct SIM_EEPROM* device, int address, unsigned char data){
+    int offset = address % device->pageSize;
+    device->pageAddress = address - offset;
+    device->pageBuffer[offset] = data;
+    device->pageLoaded[offset] = 1;
+    device->lastByte = data;
+    simStats.bytesLoaded++;
+}
+
+/*****************************************************************************/
+/******************************** Parallel ***********************************/
+/*****************************************************************************/
+
+/* Follow the JEDEC software chip erase sequence through the bytes loaded. The last
+   byte of the sequence drops the bytes loaded with it and erases the whole device.
+   Returns 1 if the chip erase started */
+int checkChipEraseSim(struct SIM_EEPROM* device, int address, unsigned char data, long long now){
+    if(EEPROM_CHIP_ERASE_USEC[device->model] == 0){
+        return 0;
+    }
+    int step = device->commandStep;
+    if(address != chipEraseAddresses[step] || data != chipEraseData[step]){
+        step = 0;
+    }
+    if(address == chipEraseAddresses[step] && data == chipEraseData[step]){
+        step++;
+    }
+    device->commandStep = step % CHIP_ERASE_SEQUENCE_LENGTH;
+    if(step < CHIP_ERASE_SEQUENCE_LENGTH){
+        return 0;
+    }
+    memset(device->pageLoaded, 0, sizeof(device->pageLoaded));
+    device->isLoading = 0;
+    device->isBusy = 1;
+    device->isChipErasing = 1;
+    device->busyUntil = now + EEPROM_CHIP_ERASE_USEC[device->model];
+    simStats.writeCycles++;
+    return 1;
+}
+
+/* Get the address set on the address pins */
+int getAddressSim(){
+    int address = 0;
+    for(int i = wiring.numAddressPins-1; i >= 0; i--){
+        address = (address << 1) | lineLevels[wiring.addressPins[i]];
+    }
+    return address % parallelDevice.size;
+}
+
+/* Get the data set on the data pins */
+unsigned char getDataSim(){
+    unsigned char data = 0;
+    for(int i = 0; i < MAX_SIM_LINES; i++){
+        if(wiring.lineDataBit[i] != -1){
+            data |= lineLevels[i] << wiring.lineDataBit[i];
+        }
+    }
+    return data;
+}
+
+/* Get the byte the EEPROM drives onto the data pins or -1 if they are not driven */
+int getDrivenByteSim(){
+    if(!wiring.isConnected || lineLevels[wiring.chipEnablePin] != LOW || \
+            lineLevels[wiring.outputEnablePin] != LOW || lineLevels[wiring.writeEnablePin] != HIGH){
+        return -1;
+    }
+    updateDeviceSim(&parallelDevice, getTimeSim());
+    if(parallelDevice.isLoading || parallelDevice.isBusy){
+        // Data polling inverts I/O7 and toggle bit polling toggles I/O6 until the write finishes
+        return (~parallelDevice.lastByte & 0x80) | (parallelDevice.toggleBit << 6) | (parallelDevice.lastByte & 0x3F);
+    }
+    return parallelDevice.memory[getAddressSim()];
+}
+
+/* Get the level of a line as seen by the Pi */
+int getLineLevelSim(int line, int drivenByte){
+    if(drivenByte != -1 && wiring.lineDataBit[line] != -1){
+        return (drivenByte >> wiring.lineDataBit[line]) & 1;
+    }
+    if(wiring.isConnected && line == wiring.readyBusyPin){
+        // RDY/BUSY is pulled LOW for the duration of the write cycle
+        updateDeviceSim(&parallelDevice, getTimeSim());
+        return parallelDevice.isBusy ? LOW : HIGH;
+    }
+    return lineLevels[line];
+}
+
+/* Act on the edges of the control pins */
+void evaluateParallelSim(){
+    if(!wiring.isConnected){
+        return;
+    }
+    int ce = lineLevels[wiring.chipEnablePin];
+    int oe = lineLevels[wiring.outputEnablePin];
+    int we = lineLevels[wiring.writeEnablePin];
+    long long now = getTimeSim();
+
+    updateDeviceSim(&parallelDevice, now);
+    if(ce == LOW && oe == HIGH){
+        // Address is latched on the falling edge of WE and data on the rising edge.
+        // The byte load cycle time only runs while WE is HIGH
+        if(wiring.lastWE == HIGH && we == LOW){
+            parallelDevice.address = getAddressSim();
+            if(parallelDevice.isLoading){
+                parallelDevice.loadDeadline = LLONG_MAX;
+            }
+        }
+        if(wiring.lastWE == LOW && we == HIGH){
+            if(parallelDevice.isBusy){
+                simStats.ignoredWrites++;
+            } else if(!checkChipEraseSim(&parallelDevice, parallelDevice.address, getDataSim(), now)){
+                loadByteSim(&parallelDevice, parallelDevice.address, getDataSim());
+                if(parallelDevice.usePageMode){
+                    parallelDevice.isLoading = 1;
+                    parallelDevice.loadDeadline = now + BYTE_LOAD_CYCLE_USEC;
+                } else {
+                    startWriteCycleSim(&parallelDevice, now);
+                }
+            }
+        }
+    }
+    if(ce == LOW && wiring.lastOE == HIGH && oe == LOW){
+        // Reading ends the page load
+        if(parallelDevice.isLoading){
+            startWriteCycleSim(&parallelDevice, now);
+        }
+        if(parallelDevice.isBusy){
+            parallelDevice.toggleBit ^= 1;
+        }
+    }
+    wiring.lastCE = ce;
+    wiring.lastOE = oe;
+    wiring.lastWE = we;
+}
+
+/*****************************************************************************/
+/********************************** GPIO *************************************/
+/*****************************************************************************/
+
+/* Sets up simulated GPIO lines */
+int setupSim(struct GPIO_CHIP* gpioChip){
+    if(strcmp(gpioChip->chipname, "gpiochip0")){
+        ulog(ERROR,"Unable to get chip by name: %s",gpioChip->chipname);
+        return -1;
+    }
+    if(gpioChip->numGPIOLines > MAX_USABLE_SIM_LINES || gpioChip->numGPIOLines < 0){
+        ulog(ERROR,"Invalid Number of Lines Requested for Chip. Max: %i",MAX_USABLE_SIM_LINES);
+        return -1;
+    }
+    wiring.isConnected = 0;
+    for(int i=0; i < gpioChip->numGPIOLines; i++){
+        gpioChip->lineBulk[i] = NULL;
+        lineLevels[i] = LOW;
+    }
+    return 0;
+}
+
+/* Set the mode of a simulated GPIO Pin */
+int setPinModeSim(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int pinMode){
+    simStats.gpioOps++;
+    return 0;
+}
+
+/* Read from a simulated GPIO Pin */
+int readSim(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    simStats.gpioOps++;
+    return getLineLevelSim(gpioLineNumber, getDrivenByteSim());
+}
+
+/* Write a level to a simulated GPIO Pin */
+int writeSim(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int level){
+    simStats.gpioOps++;
+    lineLevels[gpioLineNumber] = level;
+    evaluateParallelSim();
+    return 0;
+}
+
+/* Set every line of a bulk to be INPUT or OUTPUT */
+int setBulkModeSim(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk, int direction){
+    simStats.gpioOps++;
+    for(int i = 0; i < bulk->numLines && direction == OUTPUT; i++){
+        lineLevels[bulk->lines[i]] = bulk->values[i];
+    }
+    evaluateParallelSim();
+    return 0;
+}
+
+/* Request a group of simulated GPIO lines */
+int requestBulkSim(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    return setBulkModeSim(gpioChip, bulk, bulk->direction);
+}
+
+/* Read every line of a bulk at the same instant */
+int readBulkSim(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    int drivenByte = getDrivenByteSim();
+    int levels = 0;
+    simStats.gpioOps++;
+    for(int i = bulk->numLines-1; i >= 0; i--){
+        levels = (levels << 1) | getLineLevelSim(bulk->lines[i], drivenByte);
+    }
+    return levels;
+}
+
+/* Write several bulks at the same instant */
+int writeBulksSim(struct GPIO_CHIP* gpioChip, struct GPIO_BULK** bulks, int numBulks){
+    simStats.gpioOps++;
+    for(int j = 0; j < numBulks; j++){
+        for(int i = 0; i < bulks[j]->numLines; i++){
+            lineLevels[bulks[j]->lines[i]] = bulks[j]->values[i];
+        }
+    }
+    evaluateParallelSim();
+    return 0;
+}
+
+/* Return the lines of a bulk to being OUTPUTs at their last levels */
+void releaseBulkSim(struct GPIO_CHIP* gpioChip, struct GPIO_BULK* bulk){
+    setBulkModeSim(gpioChip, bulk, OUTPUT);
+}
+
+/* Edge events on simulated lines need no setup */
+int requestEventsSim(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+    return 0;
+}
+
+/* Sleep until the simulated EEPROM could next change a line or the timeout */
+int waitEventSim(struct GPIO_CHIP* gpioChip, int gpioLineNumber, int timeoutMSec){
+    long long now = getTimeSim();
+    long long wakeUp = now + timeoutMSec * 1000LL;
+    int ret = 0;
+
+    simStats.gpioOps++;
+    updateDeviceSim(&parallelDevice, now);
+    if(wiring.isConnected && gpioLineNumber == wiring.readyBusyPin){
+        long long change = parallelDevice.isLoading ? parallelDevice.loadDeadline : \
+                                parallelDevice.isBusy ? parallelDevice.busyUntil : LLONG_MAX;
+        if(change < wakeUp){
+            wakeUp = change;
+            ret = 1;
+        }
+    }
+    if(wakeUp > now){
+        struct timespec sleepTime = {.tv_sec = (wakeUp - now) / 1000000, .tv_nsec = ((wakeUp - now) % 1000000) * 1000};
+        nanosleep(&sleepTime, NULL);
+    }
+    return ret;
+}
+
+/* Simulated lines have nothing to release */
+void releaseEventsSim(struct GPIO_CHIP* gpioChip, int gpioLineNumber){
+}
+
+/* Disconnect the simulated EEPROM from the GPIO lines */
+void cleanupSim(struct GPIO_CHIP* gpioChip){
+    wiring.isConnected = 0;
+    wiring.writeProtectPin = -1;
+    wiring.readyBusyPin = -1;
+}
+
+/*****************************************************************************/
+/*********************************** I2C *************************************/
+/*****************************************************************************/
+
+/* Get the simulated I2C device answering to an I2C id on a bus or NULL if there is
+   none. Devices that take high address bits in the I2C id answer to the ids above
+   their own too. block is set to the offset of the I2C id from the device's own */
+struct SIM_EEPROM* getI2CDeviceSim(int bus, int i2cId, int* block){
+    if(bus < 0 || bus >= MAX_SIM_I2C_BUSES || \
+            i2cId < SIM_I2C_BASE_ID || i2cId >= SIM_I2C_BASE_ID + MAX_SIM_I2C_DEVICES){
+        return NULL;
+    }
+    for(int i = i2cId - SIM_I2C_BASE_ID; i >= 0; i--){
+        struct SIM_EEPROM* device = &i2cDevices[bus][i];
+        if(device->isPresent){
+            *block = i2cId - SIM_I2C_BASE_ID - i;
+            return *block < EEPROM_I2C_BLOCKS[device->model] ? device : NULL;
+        }
+    }
+    return NULL;
+}
+
+/* Get the simulated I2C device of a file descriptor from setupI2CSim */
+struct SIM_EEPROM* getI2CDeviceOfFdSim(int fd, int* block){
+    int device = fd - SIM_I2C_FD_BASE;
+    if(device < 0){
+        return NULL;
+    }
+    return getI2CDeviceSim(device / MAX_SIM_I2C_DEVICES, SIM_I2C_BASE_ID + device % MAX_SIM_I2C_DEVICES, block);
+}
+
+/* Sets up a simulated I2C device */
+int setupI2CSim(int bus, char I2CId){
+    int block;
+    ulog(INFO,"Setting up simulated I2C Device with ID: 0x%02x on bus %i",I2CId,bus);
+    if(getI2CDeviceSim(bus, I2CId, &block) == NULL){
+        ulog(ERROR,"Device not available");
+        return -1;
+    }
+    return SIM_I2C_FD_BASE + bus * MAX_SIM_I2C_DEVICES + I2CId - SIM_I2C_BASE_ID;
+}
+
+/* Write to a block of a simulated I2C device. Not acknowledged while a write cycle
+   is in progress. Must be called with i2cLock held */
+int writeI2CDeviceSim(struct SIM_EEPROM* device, int block, char* data, int numBytesToWrite){
+    long long now = getTimeSim();
+
+    simStats.i2cOps++;
+    if(device == NULL){
+        ulog(ERROR,"Error writing byte(s) via I2C");
+        return -1;
+    }
+    updateDeviceSim(device, now);
+    if(device->isBusy){
+        return -1;
+    }
+    if(data == NULL || numBytesToWrite == 0){
+        return 0;
+    }
+    if(numBytesToWrite < device->addressSize){
+        ulog(ERROR,"Error writing byte(s) via I2C");
+        return -1;
+    }
+
+    int address = block;
+    for(int i = 0; i < device->addressSize; i++){
+        address = (address << 8) | (unsigned char)data[i];
+    }
+    device->address = address % device->size;
+    if(numBytesToWrite == device->addressSize){
+        return numBytesToWrite;
+    }
+
+    if(wiring.writeProtectPin != -1 && lineLevels[wiring.writeProtectPin] == HIGH){
+        simStats.ignoredWrites++;
+        return numBytesToWrite;
+    }
+    // Bytes past the end of the page roll over to the start of the page
+    int pageAddress = device->address - (device->address % device->pageSize);
+    for(int i = device->addressSize; i < numBytesToWrite; i++){
+        loadByteSim(device, device->address, data[i]);
+        device->address = pageAddress + ((device->address + 1) % device->pageSize);
+    }
+    startWriteCycleSim(device, now);
+    return numBytesToWrite;
+}
+
+/* Write to a simulated I2C device */
+int writeI2CSim(int fd, char* data, int numBytesToWrite){
+    int block = 0;
+    pthread_mutex_lock(&i2cLock);
+    struct SIM_EEPROM* device = getI2CDeviceOfFdSim(fd, &block);
+    int bytesWritten = writeI2CDeviceSim(device, block, data, numBytesToWrite);
+    pthread_mutex_unlock(&i2cLock);
+    return bytesWritten;
+}
+
+/* Read sequentially from a specified address of a simulated I2C device. Like the
+   i2c-bcm2835 controller a transaction has a single read message */
+int readI2CSim(int fd, char* buf, int numBytesToRead, int addressSize){
+    int block = 0;
+    if(numBytesToRead > MAX_I2C_READ_LEN){
+        simStats.i2cOps++;
+        ulog(ERROR,"Error reading byte(s) via I2C");
+        return -1;
+    }
+    pthread_mutex_lock(&i2cLock);
+    struct SIM_EEPROM* device = getI2CDeviceOfFdSim(fd, &block);
+    if(writeI2CDeviceSim(device, block, buf, addressSize) == -1){
+        pthread_mutex_unlock(&i2cLock);
+        ulog(ERROR,"Error reading byte(s) via I2C");
+        return -1;
+    }
+    for(int i = 0; i < numBytesToRead; i++){
+        buf[i] = device->memory[device->address];
+        device->address = (device->address + 1) % device->size;
+    }
+    pthread_mutex_unlock(&i2cLock);
+    return numBytesToRead;
+}
+
+/* Nothing to close for a simulated I2C device */
+void cleanupI2CSim(int fd){
+}
+
+/*****************************************************************************/
+/*****************************************************************************/
+/*****************************************************************************/
+
+const struct GPIO_BACKEND_OPS SIM_BACKEND_OPS = {
+    .setupGPIO = setupSim,
+    .setPinModeGPIO = setPinModeSim,
+    .readGPIO = readSim,
+    .writeGPIO = writeSim,
+    .cleanupGPIO = cleanupSim,
+    .requestBulkGPIO = requestBulkSim,
+    .setBulkModeGPIO = setBulkModeSim,
+    .readBulkGPIO = readBulkSim,
+    .writeBulksGPIO = writeBulksSim,
+    .releaseBulkGPIO = releaseBulkSim,
+    .requestEventsGPIO = requestEventsSim,
+    .waitEventGPIO = waitEventSim,
+    .releaseEventsGPIO = releaseEventsSim,
+    .setupI2C = setupI2CSim,
+    .readI2C = readI2CSim,
+    .writeI2C = writeI2CSim,
+    .cleanupI2C = cleanupI2CSim
+};
+
+/* Wire a simulated EEPROM to the pins of an eeprom */
+int connectEEPROMSim(struct EEPROM* eeprom){
+    if(eeprom->type == I2C){
+        wiring.writeProtectPin = eeprom->writeProtectPin;
+        for(int i = 0; i < eeprom->numI2CDevices; i++){
+            if(addI2CDeviceSim(eeprom->model, eeprom->i2cBus, eeprom->i2cId + i * eeprom->numI2CBlocks)){
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    if(initDeviceSim(&parallelDevice, eeprom->model)){
+        return -1;
+    }
+    wiring.numAddressPins = 0;
+    for(int i = 0; i < eeprom->maxAddressLength; i++){
+        if (!((eeprom->model == AT28C64) && ((i == 13) || (i == 14)))){
+            wiring.addressPins[wiring.numAddressPins++] = eeprom->addressPins[i];
+        }
+    }
+    for(int i = 0; i < MAX_SIM_LINES; i++){
+        wiring.lineDataBit[i] = -1;
+    }
+    for(int i = 0; i < eeprom->maxDataLength; i++){
+        wiring.lineDataBit[eeprom->dataPins[i]] = i;
+    }
+    wiring.chipEnablePin = eeprom->chipEnablePin;
+    wiring.outputEnablePin = eeprom->outputEnablePin;
+    wiring.writeEnablePin = eeprom->writeEnablePin;
+    wiring.readyBusyPin = eeprom->readyBusyPin;
+    wiring.lastCE = lineLevels[wiring.chipEnablePin];
+    wiring.lastOE = lineLevels[wiring.outputEnablePin];
+    wiring.lastWE = lineLevels[wiring.writeEnablePin];
+    wiring.isConnected = 1;
+    ulog(INFO,"Connected simulated %s",EEPROM_MODEL_STRINGS[eeprom->model]);
+    return 0;
+}
+
+/* Add a simulated I2C EEPROM to the bus */
+int addI2CDeviceSim(int model, int bus, int i2cId){
+    if(model < AT24C01 || model > AT24CM02){
+        ulog(ERROR,"Simulated I2C device must be an I2C EEPROM model");
+        return -1;
+    }
+    if(bus < 0 || bus >= MAX_SIM_I2C_BUSES){
+        ulog(ERROR,"Invalid I2C bus for simulated device: %i",bus);
+        return -1;
+    }
+    int numBlocks = EEPROM_I2C_BLOCKS[model];
+    if(i2cId < SIM_I2C_BASE_ID || i2cId + numBlocks > SIM_I2C_BASE_ID + MAX_SIM_I2C_DEVICES || \
+                                                                (i2cId - SIM_I2C_BASE_ID) % numBlocks){
+        ulog(ERROR,"Invalid I2C id for simulated device: 0x%02x",i2cId);
+        return -1;
+    }
+    // The ids of the other blocks belong to this device
+    for(int i = 1; i < numBlocks; i++){
+        i2cDevices[bus][i2cId - SIM_I2C_BASE_ID + i].isPresent = 0;
+    }
+    return initDeviceSim(&i2cDevices[bus][i2cId - SIM_I2C_BASE_ID], model);
+}
+
+/* Set the write cycle time of every simulated EEPROM */
+void setWriteCycleTimeSim(int usec){
+    writeCycleUSec = usec;
+}
+
+/* Copy the counters of the simulated EEPROM backend */
+void getStatsSim(struct SIM_STATS* stats){
+    *stats = simStats;
+}
+
+/* Reset the counters of the simulated EEPROM backend */
+void resetStatsSim(){
+    memset(&simStats, 0, sizeof(simStats));
+}
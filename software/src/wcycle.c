@@ -0,0 +1,331 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "delay.h"
+#include "wcycle.h"
+#include "ulog.h"
+
+#define NSEC_PER_SEC 1000000000L
+#define NSEC_PER_USEC 1000L
+// Write cycles observed before the estimate is trusted enough to sleep on
+#define MIN_SAMPLES 4
+// Weight of a new write cycle in the estimate is 1/2^ESTIMATE_SHIFT
+#define ESTIMATE_SHIFT 3
+// Part of the estimate left to spin for is 1/2^SPIN_SHIFT. Covers both the
+// spread of the write cycle times and the scheduler waking up late
+#define SPIN_SHIFT 3
+// Write cycles a profile needs before its delay is trusted
+#define MIN_PROFILE_CYCLES 100
+// Margin added to the 99th percentile of a profile is 1/2^MARGIN_SHIFT of it
+#define MARGIN_SHIFT 2
+// Profiles are halved once they hold this many write cycles so old runs fade out
+#define MAX_PROFILE_CYCLES 100000
+#define MAX_PROFILE_LINE 1024
+#define MAX_PROFILE_PATH 512
+
+static struct WRITE_CYCLE_STATS cycleStats;
+static struct WRITE_CYCLE_PROFILE cycleProfile;
+// Write cycles of several I2C buses may be waited on from a thread each. The
+// estimate is shared while the sleep belongs to the thread that slept it
+static pthread_mutex_t cycleLock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local long long lastSleepNSec = 0;
+
+/* Forgets every observed write cycle */
+void setupWriteCycle(long long maxNSec){
+    memset(&cycleStats, 0, sizeof(cycleStats));
+    memset(&cycleProfile, 0, sizeof(cycleProfile));
+    lastSleepNSec = 0;
+    cycleStats.bucketNSec = maxNSec / WRITE_CYCLE_BUCKETS + 1;
+    cycleProfile.bucketNSec = cycleStats.bucketNSec;
+}
+
+/* Returns most of the estimated write cycle once enough have been observed */
+long long getSleepWriteCycle(){
+    long long nsec = 0;
+    pthread_mutex_lock(&cycleLock);
+    if(cycleStats.cycles >= MIN_SAMPLES){
+        nsec = cycleStats.estimateNSec - (cycleStats.estimateNSec >> SPIN_SHIFT);
+    }
+    pthread_mutex_unlock(&cycleLock);
+    return nsec;
+}
+
+/* Sleeps until most of the estimated write cycle has passed. The write cycle may
+   have been left running while something else was done so only the rest is slept */
+void sleepWriteCycle(long long startNSec){
+    long long nsec = getSleepWriteCycle();
+    long long remaining = startNSec + nsec - getTimeNSec();
+    if(nsec <= 0){
+        return;
+    }
+    if(remaining > 0){
+        struct timespec sleepTime = {.tv_sec = remaining / NSEC_PER_SEC, .tv_nsec = remaining % NSEC_PER_SEC};
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &sleepTime, NULL);
+        pthread_mutex_lock(&cycleLock);
+        cycleStats.sleptNSec += remaining;
+        pthread_mutex_unlock(&cycleLock);
+    }
+    lastSleepNSec = nsec;
+}
+
+/* Adds a write cycle to the histogram and the running estimate. A write cycle that
+   finished before the sleep did only shows how late the sleep woke up, so it is
+   recorded as the sleep that was asked for and the estimate shrinks */
+void recordWriteCycle(long long elapsedNSec, int finishedAsleep){
+    if(finishedAsleep && lastSleepNSec > 0 && lastSleepNSec < elapsedNSec){
+        elapsedNSec = lastSleepNSec;
+    }
+    lastSleepNSec = 0;
+    pthread_mutex_lock(&cycleLock);
+    long bucket = cycleStats.bucketNSec ? elapsedNSec / cycleStats.bucketNSec : 0;
+    if(bucket >= WRITE_CYCLE_BUCKETS){
+        bucket = WRITE_CYCLE_BUCKETS - 1;
+    }
+    cycleStats.histogram[bucket]++;
+
+    if(cycleStats.cycles == 0 || elapsedNSec < cycleStats.minNSec){
+        cycleStats.minNSec = elapsedNSec;
+    }
+    if(elapsedNSec > cycleStats.maxNSec){
+        cycleStats.maxNSec = elapsedNSec;
+    }
+    if(cycleStats.cycles == 0){
+        cycleStats.estimateNSec = elapsedNSec;
+    } else {
+        cycleStats.estimateNSec += (elapsedNSec - cycleStats.estimateNSec) >> ESTIMATE_SHIFT;
+    }
+    cycleStats.totalNSec += elapsedNSec;
+    cycleStats.cycles++;
+    pthread_mutex_unlock(&cycleLock);
+}
+
+/* Walks the histogram to the bucket holding the percentile */
+long long getPercentileWriteCycle(int percent){
+    long rank = (cycleStats.cycles * percent + 99) / 100;
+    long count = 0;
+
+    if(cycleStats.cycles == 0){
+        return 0;
+    }
+    for(int i = 0; i < WRITE_CYCLE_BUCKETS; i++){
+        count += cycleStats.histogram[i];
+        if(count >= rank && count > 0 && i != WRITE_CYCLE_BUCKETS - 1){
+            long long upper = (i + 1) * cycleStats.bucketNSec;
+            return upper < cycleStats.maxNSec ? upper : cycleStats.maxNSec;
+        }
+    }
+    return cycleStats.maxNSec;
+}
+
+/* Copies the observed write cycle times */
+void getStatsWriteCycle(struct WRITE_CYCLE_STATS* stats){
+    pthread_mutex_lock(&cycleLock);
+    *stats = cycleStats;
+    pthread_mutex_unlock(&cycleLock);
+}
+
+/* Reports the percentiles and the histogram of the observed write cycles */
+void reportWriteCycle(){
+    if(cycleStats.cycles == 0){
+        return;
+    }
+    ulog(INFO,"Write cycles: %li min: %lli us p50: %lli us p90: %lli us p99: %lli us max: %lli us mean: %lli us", \
+                    cycleStats.cycles, cycleStats.minNSec / NSEC_PER_USEC, \
+                    getPercentileWriteCycle(50) / NSEC_PER_USEC, getPercentileWriteCycle(90) / NSEC_PER_USEC, \
+                    getPercentileWriteCycle(99) / NSEC_PER_USEC, cycleStats.maxNSec / NSEC_PER_USEC, \
+                    cycleStats.totalNSec / cycleStats.cycles / NSEC_PER_USEC);
+    ulog(INFO,"Write cycles slept %lli us of %lli us waited", \
+                    cycleStats.sleptNSec / NSEC_PER_USEC, cycleStats.totalNSec / NSEC_PER_USEC);
+    for(int i = 0; i < WRITE_CYCLE_BUCKETS; i++){
+        if(cycleStats.histogram[i]){
+            long long upper = i == WRITE_CYCLE_BUCKETS - 1 ? cycleStats.maxNSec : (i + 1) * cycleStats.bucketNSec;
+            ulog(DEBUG,"%8lli - %8lli us: %li", i * cycleStats.bucketNSec / NSEC_PER_USEC, \
+                    upper / NSEC_PER_USEC, cycleStats.histogram[i]);
+        }
+    }
+}
+
+/* Builds the default profile path from the XDG cache directory */
+char* getDefaultProfileWriteCycle(){
+    static char path[MAX_PROFILE_PATH];
+    char* cacheHome = getenv("XDG_CACHE_HOME");
+    char* home = getenv("HOME");
+    int len = -1;
+
+    if(cacheHome != NULL && cacheHome[0] != '\0'){
+        len = snprintf(path, sizeof(path), "%s/piepro/write-cycles", cacheHome);
+    } else if(home != NULL && home[0] != '\0'){
+        len = snprintf(path, sizeof(path), "%s/.cache/piepro/write-cycles", home);
+    }
+    if(len < 0 || len >= (int)sizeof(path)){
+        return NULL;
+    }
+    return path;
+}
+
+/* Parses a profile line of a model. Returns 0 if it belongs to the model and is valid */
+int parseProfileWriteCycle(char* line, const char* model, struct WRITE_CYCLE_PROFILE* profile){
+    char* token = strtok(line, " \n");
+    if(token == NULL || strcmp(token, model)){
+        return -1;
+    }
+    long long fields[3 + WRITE_CYCLE_BUCKETS];
+    for(int i = 0; i < 3 + WRITE_CYCLE_BUCKETS; i++){
+        token = strtok(NULL, " \n");
+        if(token == NULL){
+            return -1;
+        }
+        fields[i] = strtoll(token, NULL, 10);
+        if(fields[i] < 0){
+            return -1;
+        }
+    }
+    profile->bucketNSec = fields[0];
+    profile->cycles = fields[1];
+    profile->maxNSec = fields[2];
+    for(int i = 0; i < WRITE_CYCLE_BUCKETS; i++){
+        profile->histogram[i] = fields[3 + i];
+    }
+    return 0;
+}
+
+/* Loads the profile line of a model */
+int loadProfileWriteCycle(const char* filename, const char* model){
+    struct WRITE_CYCLE_PROFILE profile;
+    char line[MAX_PROFILE_LINE];
+    int err = -1;
+
+    FILE* file = fopen(filename, "r");
+    if(file == NULL){
+        ulog(DEBUG,"No write cycle profile: %s",filename);
+        return -1;
+    }
+    while(err && fgets(line, sizeof(line), file) != NULL){
+        err = parseProfileWriteCycle(line, model, &profile);
+    }
+    fclose(file);
+
+    if(err){
+        ulog(DEBUG,"No write cycle profile for %s in %s",model,filename);
+        return -1;
+    }
+    if(profile.bucketNSec != cycleProfile.bucketNSec){
+        ulog(WARNING,"Ignoring write cycle profile for %s with a different range",model);
+        return -1;
+    }
+    cycleProfile = profile;
+    ulog(INFO,"Loaded write cycle profile for %s of %li write cycles",model,cycleProfile.cycles);
+    return 0;
+}
+
+/* Creates every missing directory above a file */
+void makeParentDirectories(const char* filename){
+    char path[MAX_PROFILE_PATH];
+    snprintf(path, sizeof(path), "%s", filename);
+    for(char* slash = strchr(path + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')){
+        *slash = '\0';
+        if(mkdir(path, 0755) && errno != EEXIST){
+            return;
+        }
+        *slash = '/';
+    }
+}
+
+/* Merges this run into the profile and rewrites the profile file through a temporary file */
+int saveProfileWriteCycle(const char* filename, const char* model){
+    char tempFilename[MAX_PROFILE_PATH];
+    char line[MAX_PROFILE_LINE];
+    char lineCopy[MAX_PROFILE_LINE];
+    struct WRITE_CYCLE_PROFILE otherProfile;
+
+    if(cycleStats.cycles == 0){
+        return 0;
+    }
+    if(cycleProfile.cycles + cycleStats.cycles > MAX_PROFILE_CYCLES){
+        cycleProfile.cycles = 0;
+        for(int i = 0; i < WRITE_CYCLE_BUCKETS; i++){
+            cycleProfile.histogram[i] /= 2;
+            cycleProfile.cycles += cycleProfile.histogram[i];
+        }
+    }
+    for(int i = 0; i < WRITE_CYCLE_BUCKETS; i++){
+        cycleProfile.histogram[i] += cycleStats.histogram[i];
+    }
+    cycleProfile.cycles += cycleStats.cycles;
+    if(cycleStats.maxNSec > cycleProfile.maxNSec){
+        cycleProfile.maxNSec = cycleStats.maxNSec;
+    }
+
+    if(snprintf(tempFilename, sizeof(tempFilename), "%s.tmp", filename) >= (int)sizeof(tempFilename)){
+        ulog(WARNING,"Write cycle profile path is too long: %s",filename);
+        return -1;
+    }
+    makeParentDirectories(filename);
+    FILE* tempFile = fopen(tempFilename, "w");
+    if(tempFile == NULL){
+        ulog(WARNING,"Unable to save write cycle profile: %s",filename);
+        return -1;
+    }
+
+    // Keep the profiles of the other models
+    FILE* file = fopen(filename, "r");
+    if(file != NULL){
+        while(fgets(line, sizeof(line), file) != NULL){
+            memcpy(lineCopy, line, sizeof(line));
+            char* name = strtok(lineCopy, " \n");
+            if(name != NULL && strcmp(name, model) && !parseProfileWriteCycle(line, name, &otherProfile)){
+                fprintf(tempFile, "%s %lli %li %lli", name, otherProfile.bucketNSec, \
+                                                            otherProfile.cycles, otherProfile.maxNSec);
+                for(int i = 0; i < WRITE_CYCLE_BUCKETS; i++){
+                    fprintf(tempFile, " %li", otherProfile.histogram[i]);
+                }
+                fprintf(tempFile, "\n");
+            }
+        }
+        fclose(file);
+    }
+
+    fprintf(tempFile, "%s %lli %li %lli", model, cycleProfile.bucketNSec, cycleProfile.cycles, cycleProfile.maxNSec);
+    for(int i = 0; i < WRITE_CYCLE_BUCKETS; i++){
+        fprintf(tempFile, " %li", cycleProfile.histogram[i]);
+    }
+    fprintf(tempFile, "\n");
+    if(fclose(tempFile) || rename(tempFilename, filename)){
+        ulog(WARNING,"Unable to save write cycle profile: %s",filename);
+        remove(tempFilename);
+        return -1;
+    }
+    ulog(INFO,"Saved write cycle profile for %s of %li write cycles",model,cycleProfile.cycles);
+    return 0;
+}
+
+/* Walks the profile histogram to the 99th percentile and adds the margin */
+long long getLearnedDelayWriteCycle(){
+    long rank = (cycleProfile.cycles * 99 + 99) / 100;
+    long count = 0;
+    long long p99 = cycleProfile.maxNSec;
+
+    if(cycleProfile.cycles < MIN_PROFILE_CYCLES){
+        return 0;
+    }
+    for(int i = 0; i < WRITE_CYCLE_BUCKETS - 1; i++){
+        count += cycleProfile.histogram[i];
+        if(count >= rank){
+            if((i + 1) * cycleProfile.bucketNSec < p99){
+                p99 = (i + 1) * cycleProfile.bucketNSec;
+            }
+            break;
+        }
+    }
+    return p99 + (p99 >> MARGIN_SHIFT);
+}
+
+/* Copies the loaded profile */
+void getProfileWriteCycle(struct WRITE_CYCLE_PROFILE* profile){
+    *profile = cycleProfile;
+}
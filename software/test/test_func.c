@@ -4,9 +4,14 @@
 #include <sys/stat.h>
 
 #include "uTest.h"
+#include "../include/delay.h"
+#include "../include/gang.h"
 #include "../include/piepro.h"
+#include "../include/rt.h"
+#include "../include/sim.h"
 #include "../include/ulog.h"
 #include "../include/utils.h"
+#include "../include/wcycle.h"
 
 char* defaultPath = "test/data";
 char* defaultFilename = "test/data/eeprom.bin";
@@ -106,10 +111,10 @@ int get_random_data(int limit){
     return (rand() % (limit - 0 + 1));
 }
 
-void init_test(){
-    setDefaultOptions(&options);
+void init_test_with_options(){
     init_test_romFile(filename);
     options.eepromModel = eepromModel;
+    options.gpioBackend = getBackendGPIO();
     initHardware(&options, &eeprom, &gpioConfig);
 
     if(useLimit){
@@ -118,6 +123,11 @@ void init_test(){
     }
 }
 
+void init_test(){
+    setDefaultOptions(&options);
+    init_test_with_options();
+}
+
 void cleanup_test(){
     fclose(romFile);
     cleanupHardware(&gpioConfig, &eeprom);
@@ -157,6 +167,264 @@ void test_writeBinaryFileToEEPROM(){
     cleanup_test();
 }
 
+// TEST - Write only the changed Pages of a Binary File to EEPROM
+void test_writeChangedPagesOfBinaryFileToEEPROM(){
+    struct SIM_STATS stats;
+    init_test();
+
+    // Start from the file and change two bytes of the first page and one of the third
+    int changedAddresses[] = {1, 3, 2 * eeprom.pageSize + 5};
+    eeprom.forceWrite = 1;
+    eeprom.quick = 1;
+    writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    eeprom.quick = 0;
+    for(int i = 0; i < 3; i++){
+        fseek(romFile, changedAddresses[i], SEEK_SET);
+        writeByteToAddress(&gpioConfig, &eeprom, changedAddresses[i], ~fgetc(romFile));
+    }
+    rewind(romFile);
+    eeprom.forceWrite = 0;
+    eeprom.byteWriteCounter = 0;
+    eeprom.byteReadCounter = 0;
+    resetStatsSim();
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    // The unchanged byte between the two changes of the first page is cheaper to
+    // write again than another write cycle when the EEPROM has page writes
+    int numBytesWritten = eeprom.usePageWrite ? 4 : 3;
+    int numWriteCycles = eeprom.usePageWrite ? 2 : 3;
+    actual_result += eeprom.byteWriteCounter;
+    // The EEPROM is read once plus once more for each byte written to validate it
+    int endAddress = eeprom.limit < get_file_size(romFile) ? eeprom.limit : get_file_size(romFile);
+    actual_result += eeprom.byteReadCounter > endAddress + numBytesWritten;
+    getStatsSim(&stats);
+    if(getBackendGPIO() == SIM){
+        actual_result += (stats.writeCycles < numWriteCycles || stats.writeCycles > numWriteCycles + 1);
+    }
+    rewind(romFile);
+    actual_result += compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    expected = 0 + numBytesWritten + 0 + 0 + 0;
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Quick Write a Padded Binary File to EEPROM after an Erase
+void test_quickWritePaddedBinaryFileToEEPROMAfterErase(){
+    init_test();
+
+    // Pad every other page of the file with the erased byte
+    int fileSize = get_file_size(romFile);
+    int endAddress = eeprom.limit < fileSize ? eeprom.limit : fileSize;
+    char* image = malloc(fileSize);
+    fread(image, 1, fileSize, romFile);
+    int numBytesNotPadded = 0;
+    for(int i = 0; i < fileSize; i++){
+        if((i / eeprom.pageSize) % 2){
+            image[i] = 0xFF;
+        } else if(i < endAddress){
+            numBytesNotPadded++;
+        }
+    }
+    FILE* paddedFile = fopen("test/data/eeprom-padded.bin", "w+");
+    fwrite(image, 1, fileSize, paddedFile);
+    rewind(paddedFile);
+    free(image);
+
+    eraseEEPROM(&gpioConfig,&eeprom,0xFF);
+    eeprom.byteWriteCounter = 0;
+    eeprom.byteReadCounter = 0;
+    eeprom.quick = 1;
+    eeprom.forceWrite = 1;
+
+    // Only the pages that are not padding are written and nothing is read
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,paddedFile);
+    actual_result += eeprom.byteWriteCounter + eeprom.byteReadCounter;
+    rewind(paddedFile);
+    actual_result += compareFileToEEPROM(&gpioConfig,&eeprom,paddedFile);
+
+    // Writing again with an erase first leaves the same contents
+    eeprom.eraseFirst = 1;
+    eeprom.eraseByte = 0xFF;
+    rewind(paddedFile);
+    actual_result += writeFileToEEPROM(&gpioConfig,&eeprom,paddedFile);
+    rewind(paddedFile);
+    actual_result += compareFileToEEPROM(&gpioConfig,&eeprom,paddedFile);
+    expected = 0 + numBytesNotPadded + 0 + 0 + 0 + 0;
+    fclose(paddedFile);
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Force Write Binary File to EEPROM in Real-Time Mode
+void test_forceWriteBinaryFileToEEPROMRealTime(){
+    struct RT_STATS stats;
+    init_test();
+
+    eeprom.forceWrite = 1;
+    setupRealTime(-1);
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    getStatsRealTime(&stats);
+    // Only parallel bus operations run in real-time
+    actual_result += (eeprom.type == PARALLEL) != (stats.sections > 0);
+    expected = 0 + get_file_size(romFile) + 0;
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Force Write Binary File to EEPROM with Toggle Bit Polling
+void test_forceWriteBinaryFileToEEPROMToggleBitPolling(){
+    init_test();
+
+    eeprom.forceWrite = 1;
+    eeprom.pollingMethod = TOGGLE_BIT_POLLING;
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    expected = 0 + get_file_size(romFile) + 0;
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Force Write Binary File to EEPROM sleeping for most of each write cycle
+void test_forceWriteBinaryFileToEEPROMSleepWriteCycle(){
+    struct WRITE_CYCLE_STATS stats;
+    init_test();
+
+    eeprom.forceWrite = 1;
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    expected = 0 + get_file_size(romFile) + 0;
+
+    // Every write cycle is observed and once the estimate settles they are mostly slept
+    getStatsWriteCycle(&stats);
+    if(stats.cycles != eeprom.byteWriteCounter || stats.sleptNSec < stats.totalNSec / 2){
+        actual_result = -1;
+    }
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Write Binary File to EEPROM with a Write Delay Learned from a Profile
+void test_forceWriteBinaryFileToEEPROMLearnedDelay(){
+    const char* profileFilename = "test/data/write-cycles";
+    int learnedDelay = 0;
+    remove(profileFilename);
+    // The simulated EEPROM finishes well within the datasheet write cycle time of
+    // every model. The learned delay also covers tBLC and its margin
+    const int simWriteCycleUSec = 1000;
+    setWriteCycleTimeSim(simWriteCycleUSec);
+
+    // Learn the write cycle time while polling
+    setDefaultOptions(&options);
+    options.profileFile = (char*)profileFilename;
+    init_test_with_options();
+    eeprom.forceWrite = 1;
+    writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    cleanup_test();
+
+    // Write again with the learned delay instead of polling
+    setDefaultOptions(&options);
+    options.profileFile = (char*)profileFilename;
+    options.useWriteCyclePolling = 0;
+    init_test_with_options();
+    eeprom.forceWrite = 1;
+    learnedDelay = eeprom.useLearnedDelay ? eeprom.writeCycleTime : -1;
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    expected = 0 + get_file_size(romFile) + 0;
+    if(learnedDelay < simWriteCycleUSec || learnedDelay >= EEPROM_WRITE_CYCLE_USEC[eeprom.model]){
+        actual_result = -1;
+    }
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+    setWriteCycleTimeSim(-1);
+    remove(profileFilename);
+}
+
+// TEST - Quick Write Binary File to EEPROM with the Datasheet Write Delay
+void test_quickWriteBinaryFileToEEPROMWriteDelay(){
+    init_test();
+
+    // Pages only start their write cycle once tBLC passes so the delay has to cover it
+    eeprom.quick = 1;
+    eeprom.useWriteCyclePolling = 0;
+    eeprom.limit = 4 * eeprom.pageSize;
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    expected = 0 + eeprom.limit + 0;
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Quick Write Binary File to EEPROM with a Write Cycle that Times Out
+void test_quickWriteBinaryFileToEEPROMWriteTimeout(){
+    init_test();
+
+    // The write stops at the first write cycle that does not finish in time
+    eeprom.quick = 1;
+    eeprom.writeTimeout = 10;
+    setWriteCycleTimeSim(100000);
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    actual_result += eeprom.byteWriteCounter;
+    // I2C pages are sent before their write cycle is polled
+    expected = -1 + (eeprom.type == I2C ? eeprom.pageSize : 0);
+    if(getBackendGPIO() != SIM){
+        actual_result = expected;
+    }
+
+    expect(expected, actual_result);
+    
+    // Let the simulated write cycle finish before the next test
+    usleep(100000);
+    setWriteCycleTimeSim(-1);
+    cleanup_test();
+}
+
+// TEST - Quick Write Binary File to EEPROM with Ready/Busy Polling
+void test_quickWriteBinaryFileToEEPROMReadyBusyPolling(){
+    init_test();
+
+    eeprom.quick = 1;
+    eeprom.pollingMethod = READY_BUSY_POLLING;
+    if(eeprom.readyBusyPin != -1){
+        requestEventsGPIO(&gpioConfig.gpioChip, eeprom.readyBusyPin);
+    }
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    expected = 0 + get_file_size(romFile) + 0;
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
 // TEST - Write Binary File to EEPROM with Negative start value
 void test_writeBinaryFileToEEPROMWithNegativeStartValue(){
     init_test();
@@ -297,6 +565,153 @@ void test_quickWriteBinaryFileToEEPROM(){
     cleanup_test();
 }
 
+// TEST - Quick Write Binary File to EEPROM with one write cycle per page
+void test_quickWriteBinaryFileToEEPROMPageWrite(){
+    struct SIM_STATS stats;
+    init_test();
+
+    eeprom.quick = 1;
+    resetStatsSim();
+
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    expected = 0 + get_file_size(romFile) + 0;
+    // Only the simulated EEPROM counts write cycles. A page is only split in two
+    // when the process is descheduled for longer than the byte load window
+    getStatsSim(&stats);
+    if(getBackendGPIO() == SIM && eeprom.type == PARALLEL){
+        int bytesPerWriteCycle = eeprom.usePageWrite ? eeprom.pageSize : 1;
+        int numWriteCycles = (get_file_size(romFile) + bytesPerWriteCycle - 1) / bytesPerWriteCycle;
+        if(eeprom.usePageWrite){
+            actual_result += (stats.writeCycles < numWriteCycles || stats.writeCycles >= 2 * numWriteCycles);
+        } else {
+            actual_result += (stats.writeCycles != numWriteCycles);
+        }
+    }
+    // Each I2C page is written as the acknowledge poll of the page before it and
+    // only a few polls are needed once the write cycle estimate settles
+    if(getBackendGPIO() == SIM && eeprom.type == I2C){
+        int numWriteCycles = (get_file_size(romFile) + eeprom.pageSize - 1) / eeprom.pageSize;
+        actual_result += (stats.writeCycles != numWriteCycles || stats.i2cOps > 8 * numWriteCycles + 64);
+    }
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Quick Write Binary File to four I2C EEPROMs at once
+void test_quickWriteBinaryFileToEEPROMMultipleI2CDevices(){
+    struct SIM_STATS stats;
+    setDefaultOptions(&options);
+    options.numI2CDevices = 4;
+    // Parts that take address bits in the I2C id leave fewer ids for more devices
+    if(options.numI2CDevices * EEPROM_I2C_BLOCKS[eepromModel] > MAX_I2C_DEVICES){
+        options.numI2CDevices = MAX_I2C_DEVICES / EEPROM_I2C_BLOCKS[eepromModel];
+    }
+    init_test_with_options();
+
+    eeprom.quick = 1;
+    resetStatsSim();
+
+    long long start = getTimeNSec();
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    long long elapsed = getTimeNSec() - start;
+    rewind(romFile);
+    actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    expected = 0 + get_file_size(romFile) + 0;
+    // Each device writes a page while the others finish their write cycle so
+    // writing all of them takes about as long as writing one
+    getStatsSim(&stats);
+    if(getBackendGPIO() == SIM && eeprom.type == I2C){
+        int numWriteCycles = (get_file_size(romFile) + eeprom.pageSize - 1) / eeprom.pageSize;
+        actual_result += (stats.writeCycles != eeprom.numI2CDevices * numWriteCycles);
+        actual_result += (elapsed > 2000LL * EEPROM_WRITE_CYCLE_USEC[eeprom.model] * numWriteCycles);
+    }
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Quick Write Binary File to EEPROMs on two I2C buses at once
+void test_quickWriteBinaryFileToEEPROMMultipleI2CBuses(){
+    struct SIM_STATS stats;
+    struct GANG_RESULT result;
+    setDefaultOptions(&options);
+    options.i2cBuses[1] = 3;
+    options.numI2CBuses = 2;
+    init_test_with_options();
+
+    eeprom.quick = 1;
+    resetStatsSim();
+
+    options.filename = filename;
+    options.action = WRITE_FILE_TO_ROM;
+    if(eeprom.type == I2C){
+        actual_result = runGangI2C(&options, &gpioConfig, &eeprom, &result);
+        options.action = COMPARE_FILE_TO_ROM;
+        actual_result += eeprom.byteWriteCounter + runGangI2C(&options, &gpioConfig, &eeprom, &result);
+    } else {
+        actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+        rewind(romFile);
+        actual_result += eeprom.byteWriteCounter + compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    }
+    expected = 0 + get_file_size(romFile) * (eeprom.type == I2C ? options.numI2CBuses : 1) + 0;
+    // Each bus writes every page of its own EEPROM
+    getStatsSim(&stats);
+    if(getBackendGPIO() == SIM && eeprom.type == I2C){
+        int numWriteCycles = (get_file_size(romFile) + eeprom.pageSize - 1) / eeprom.pageSize;
+        actual_result += (stats.writeCycles != options.numI2CBuses * numWriteCycles);
+    }
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Write a Page to each Block of an I2C EEPROM that takes Address Bits in the I2C id
+void test_writePageToEachI2CBlock(){
+    setDefaultOptions(&options);
+    init_test_romFile(filename);
+    options.eepromModel = EEPROM_I2C_BLOCKS[eepromModel] > 1 ? eepromModel : AT24CM02;
+    options.gpioBackend = getBackendGPIO();
+    if(options.eepromModel != eepromModel && options.gpioBackend != SIM){
+        // The programmer has no such EEPROM to test
+        expect(0, 0);
+        fclose(romFile);
+        return;
+    }
+    initHardware(&options, &eeprom, &gpioConfig);
+
+    int blockSize = 1 << (8 * eeprom.addressSize);
+    char page[eeprom.addressSize + eeprom.pageSize];
+    char readBuf[eeprom.pageSize + 1 + eeprom.addressSize];
+    actual_result = 0;
+    // The last page of each block is filled with the number of the block
+    for(int block = 0; block < eeprom.numI2CBlocks; block++){
+        memset(page + eeprom.addressSize, block + 1, eeprom.pageSize);
+        actual_result += writeNumBytesToAddress(&gpioConfig, &eeprom, page + eeprom.addressSize, \
+                                            (block + 1) * blockSize - eeprom.pageSize, eeprom.pageSize);
+    }
+    // Each read but the last runs one byte into the next block
+    for(int block = 0; block < eeprom.numI2CBlocks; block++){
+        int numBytes = eeprom.pageSize + (block < eeprom.numI2CBlocks - 1);
+        if(readNumBytesFromAddress(&gpioConfig, &eeprom, readBuf, \
+                                    (block + 1) * blockSize - eeprom.pageSize, numBytes) == numBytes){
+            for(int i = 0; i < eeprom.pageSize; i++){
+                actual_result += (readBuf[i] == block + 1);
+            }
+        }
+    }
+    expected = 2 * eeprom.numI2CBlocks * eeprom.pageSize;
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
 // TEST - Quick Write Binary File to EEPROM with Negative start value
 void test_quickWriteBinaryFileToEEPROMWithNegativeStartValue(){
     init_test();
@@ -824,6 +1239,111 @@ void test_quickCompareBinaryFileToEEPROM(){
     cleanup_test();
 }
 
+// TEST - Quick Write and Compare Binary File to EEPROM from a Pipe
+void test_quickCompareBinaryFileToEEPROMFromPipe(){
+    char command[256];
+    init_test();
+    
+    eeprom.quick = 1;
+    snprintf(command, sizeof(command), "cat %s", options.filename);
+
+    // Pipes cannot be mapped so they are read into a buffer instead
+    FILE* pipeFile = popen(command, "r");
+    actual_result = writeFileToEEPROM(&gpioConfig,&eeprom,pipeFile);
+    pclose(pipeFile);
+    pipeFile = popen(command, "r");
+    actual_result += compareFileToEEPROM(&gpioConfig,&eeprom,pipeFile);
+    pclose(pipeFile);
+    actual_result += eeprom.byteReadCounter;
+    expected = 0 + 0 + get_file_size(romFile);
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Compare Binary File to four I2C EEPROMs from a Pipe with Start value
+void test_compareBinaryFileToEEPROMsFromPipeWithStartValue(){
+    char command[256];
+    setDefaultOptions(&options);
+    options.numI2CDevices = 4;
+    if(options.numI2CDevices * EEPROM_I2C_BLOCKS[eepromModel] > MAX_I2C_DEVICES){
+        options.numI2CDevices = MAX_I2C_DEVICES / EEPROM_I2C_BLOCKS[eepromModel];
+    }
+    init_test_with_options();
+
+    eeprom.quick = 1;
+    writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    eeprom.quick = 0;
+    eeprom.startValue = eeprom.pageSize + 3;
+    eeprom.byteReadCounter = 0;
+
+    // The pipe is read once and each page of it is compared to every device
+    snprintf(command, sizeof(command), "cat %s", options.filename);
+    FILE* pipeFile = popen(command, "r");
+    actual_result = compareFileToEEPROM(&gpioConfig,&eeprom,pipeFile);
+    pclose(pipeFile);
+    actual_result += eeprom.byteReadCounter;
+    int fileSize = get_file_size(romFile);
+    int endAddress = eeprom.limit < fileSize ? eeprom.limit : fileSize;
+    expected = 0 + eeprom.numI2CDevices * (endAddress - eeprom.startValue);
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Quick Compare Binary File to EEPROM in Gray Code Order
+void test_quickCompareBinaryFileToEEPROMGrayCode(){
+    init_test();
+    
+    eeprom.quick = 1;
+
+    writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    eeprom.useGrayCode = (eeprom.type == PARALLEL);
+    eeprom.readChunk = eeprom.size;
+    actual_result = compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    actual_result += eeprom.byteReadCounter;
+    expected = 0 + get_file_size(romFile) + 0;
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
+// TEST - Quick Compare Binary File to EEPROM with one I2C Transaction per Read
+void test_quickCompareBinaryFileToEEPROMI2CTransactions(){
+    struct SIM_STATS stats;
+    init_test();
+    
+    eeprom.quick = 1;
+
+    writeFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    rewind(romFile);
+    resetStatsSim();
+    actual_result = compareFileToEEPROM(&gpioConfig,&eeprom,romFile);
+    actual_result += eeprom.byteReadCounter;
+    expected = 0 + get_file_size(romFile) + 0;
+    // Each block is read with one combined write and read for every MAX_I2C_READ_LEN
+    // bytes since a transaction only takes a single read message
+    getStatsSim(&stats);
+    if(getBackendGPIO() == SIM && eeprom.type == I2C){
+        int blockSize = 1 << (8 * eeprom.addressSize);
+        int numTransactions = 0;
+        for(int address = 0; address < get_file_size(romFile);){
+            int numBytes = blockSize - (address % blockSize);
+            address += numBytes < MAX_I2C_READ_LEN ? numBytes : MAX_I2C_READ_LEN;
+            numTransactions++;
+        }
+        actual_result += (stats.i2cOps != numTransactions);
+    }
+
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
 // TEST - Quick Compare Binary File to EEPROM with Negative start value
 void test_quickCompareBinaryFileToEEPROMWithNegativeStartValue(){
     init_test();
@@ -1910,6 +2430,41 @@ void test_defaultEraseEEPROM(){
     cleanup_test();
 }
 
+// TEST - Erase EEPROM with a Chip Erase or by skipping Erased Pages
+void test_eraseEEPROMChipErase(){
+    struct SIM_STATS stats;
+    init_test();
+
+    // Start from an erased EEPROM with a single byte that is not erased
+    eraseEEPROM(&gpioConfig,&eeprom,options.eraseByte);
+    eeprom.forceWrite = 1;
+    writeByteToAddress(&gpioConfig,&eeprom,eeprom.pageSize + 1,~options.eraseByte);
+    eeprom.forceWrite = 0;
+    eeprom.byteWriteCounter = 0;
+    resetStatsSim();
+
+    actual_result = eraseEEPROM(&gpioConfig,&eeprom,options.eraseByte);
+    // Parts with a chip erase erase every byte in one write cycle. The others only
+    // write the page that is not erased
+    int useChipErase = eeprom.type == PARALLEL && EEPROM_CHIP_ERASE_USEC[eeprom.model] > 0;
+    actual_result += eeprom.byteWriteCounter;
+    expected = useChipErase ? eeprom.size : 1;
+    getStatsSim(&stats);
+    if(getBackendGPIO() == SIM){
+        actual_result += stats.writeCycles != 1;
+    }
+
+    for(int i=0; i < eeprom.size; i++){
+        if(readByteFromAddress(&gpioConfig,&eeprom,i) != options.eraseByte){
+            ++actual_result;
+        }
+    }
+    
+    expect(expected, actual_result);
+    
+    cleanup_test();
+}
+
 // TEST - Erase EEPROM with Negative start value
 void test_eraseEEPROMWithNegativeStartValue(){
     init_test();
@@ -2324,6 +2879,15 @@ int run_piepro_functional_tests(int testType, int eepromModelToTest, int generat
     addFuncSuite(suite0);
     addFuncTest("Force Write Binary File to EEPROM", getCurrentFuncSuite(), test_forceWriteBinaryFileToEEPROM);
     addFuncTest("Default Write Binary File to EEPROM", getCurrentFuncSuite(), test_writeBinaryFileToEEPROM);
+    addFuncTest("Write only the changed Pages of a Binary File to EEPROM", getCurrentFuncSuite(), test_writeChangedPagesOfBinaryFileToEEPROM);
+    addFuncTest("Quick Write a Padded Binary File to EEPROM after an Erase", getCurrentFuncSuite(), test_quickWritePaddedBinaryFileToEEPROMAfterErase);
+    addFuncTest("Force Write Binary File to EEPROM in Real-Time Mode", getCurrentFuncSuite(), test_forceWriteBinaryFileToEEPROMRealTime);
+    addFuncTest("Force Write Binary File to EEPROM with Toggle Bit Polling", getCurrentFuncSuite(), test_forceWriteBinaryFileToEEPROMToggleBitPolling);
+    addFuncTest("Force Write Binary File to EEPROM sleeping for most of each write cycle", getCurrentFuncSuite(), test_forceWriteBinaryFileToEEPROMSleepWriteCycle);
+    addFuncTest("Write Binary File to EEPROM with a Write Delay Learned from a Profile", getCurrentFuncSuite(), test_forceWriteBinaryFileToEEPROMLearnedDelay);
+    addFuncTest("Quick Write Binary File to EEPROM with the Datasheet Write Delay", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMWriteDelay);
+    addFuncTest("Quick Write Binary File to EEPROM with a Write Cycle that Times Out", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMWriteTimeout);
+    addFuncTest("Quick Write Binary File to EEPROM with Ready/Busy Polling", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMReadyBusyPolling);
     addFuncTest("Write Binary File to EEPROM with Negative Start value", getCurrentFuncSuite(), test_writeBinaryFileToEEPROMWithNegativeStartValue);
     addFuncTest("Write Binary File to EEPROM with Start value", getCurrentFuncSuite(), test_writeBinaryFileToEEPROMWithStartValue);
     addFuncTest("Write Binary File to EEPROM with Limit", getCurrentFuncSuite(), test_writeBinaryFileToEEPROMWithLimit);
@@ -2332,6 +2896,10 @@ int run_piepro_functional_tests(int testType, int eepromModelToTest, int generat
     addFuncTest("Write Binary File to EEPROM with Start Value and Excess Limit", getCurrentFuncSuite(), test_writeBinaryFileToEEPROMWithStartValueExcessLimit);
     addFuncTest("Write Binary File to EEPROM with Oversize file", getCurrentFuncSuite(), test_writeBinaryFileToEEPROMWithOversizeFile);
     addFuncTest("Quick Write Binary File to EEPROM", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROM);
+    addFuncTest("Quick Write Binary File to EEPROM with one write cycle per page", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMPageWrite);
+    addFuncTest("Quick Write Binary File to four I2C EEPROMs at once", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMMultipleI2CDevices);
+    addFuncTest("Quick Write Binary File to EEPROMs on two I2C buses at once", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMMultipleI2CBuses);
+    addFuncTest("Write a Page to each Block of an I2C EEPROM", getCurrentFuncSuite(), test_writePageToEachI2CBlock);
     addFuncTest("Quick Write Binary File to EEPROM with Negative Start value", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMWithNegativeStartValue);
     addFuncTest("Quick Write Binary File to EEPROM with Start value", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMWithStartValue);
     addFuncTest("Quick Write Binary File to EEPROM with Limit", getCurrentFuncSuite(), test_quickWriteBinaryFileToEEPROMWithLimit);
@@ -2361,6 +2929,10 @@ int run_piepro_functional_tests(int testType, int eepromModelToTest, int generat
     addFuncTest("Compare Unmatched Binary File to EEPROM with Excess Limit", getCurrentFuncSuite(), test_compareUnmatchedBinaryFileToEEPROMWithExcessLimit);
     addFuncTest("Compare Unmatched Binary File to EEPROM with Start Value and Excess Limit", getCurrentFuncSuite(), test_compareUnmatchedBinaryFileToEEPROMWithStartValueExcessLimit);
     addFuncTest("Quick Compare Binary File to EEPROM", getCurrentFuncSuite(), test_quickCompareBinaryFileToEEPROM);
+    addFuncTest("Quick Write and Compare Binary File to EEPROM from a Pipe", getCurrentFuncSuite(), test_quickCompareBinaryFileToEEPROMFromPipe);
+    addFuncTest("Compare Binary File to four I2C EEPROMs from a Pipe with Start value", getCurrentFuncSuite(), test_compareBinaryFileToEEPROMsFromPipeWithStartValue);
+    addFuncTest("Quick Compare Binary File to EEPROM in Gray Code Order", getCurrentFuncSuite(), test_quickCompareBinaryFileToEEPROMGrayCode);
+    addFuncTest("Quick Compare Binary File to EEPROM with one I2C Transaction per Read", getCurrentFuncSuite(), test_quickCompareBinaryFileToEEPROMI2CTransactions);
     addFuncTest("Quick Compare Binary File to EEPROM with Negative Start value", getCurrentFuncSuite(), test_quickCompareBinaryFileToEEPROMWithNegativeStartValue);
     addFuncTest("Quick Compare Binary File to EEPROM with Start value", getCurrentFuncSuite(), test_quickCompareBinaryFileToEEPROMWithStartValue);
     addFuncTest("Quick Compare Binary File to EEPROM with Limit", getCurrentFuncSuite(), test_quickCompareBinaryFileToEEPROMWithLimit);
@@ -2423,6 +2995,7 @@ int run_piepro_functional_tests(int testType, int eepromModelToTest, int generat
     addFuncTest("Erase EEPROM with 0", getCurrentFuncSuite(), test_eraseEEPROMWith0);
     addFuncTest("Force Erase EEPROM", getCurrentFuncSuite(), test_forceEraseEEPROM);
     addFuncTest("Default Erase EEPROM", getCurrentFuncSuite(), test_defaultEraseEEPROM);
+    addFuncTest("Erase EEPROM with a Chip Erase or by skipping Erased Pages", getCurrentFuncSuite(), test_eraseEEPROMChipErase);
     addFuncTest("Erase EEPROM with Negative Start value", getCurrentFuncSuite(), test_eraseEEPROMWithNegativeStartValue);
     addFuncTest("Erase EEPROM with Start value", getCurrentFuncSuite(), test_eraseEEPROMWithStartValue);
     addFuncTest("Erase EEPROM with Limit", getCurrentFuncSuite(), test_eraseEEPROMWithLimit);
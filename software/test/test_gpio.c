@@ -4,6 +4,7 @@
 #include "uTest.h"
 #include "../include/ulog.h"
 #include "../include/gpio.h"
+#include "../include/sim.h"
 
 
 #define NUM_LINES_TO_USE 28
@@ -13,11 +14,16 @@ int unit_test_actual_result;
 int unit_test_expected;
 
 struct GPIO_CHIP gpioChip;
+struct GPIO_BULK gpioBulk;
+int bulkLines[] = {13, 19, 26, 2};
 
 char* unitSuiteGPIO0 = "suite_setupGPIO";
 char* unitSuiteGPIO1 = "test_setPinModeGPIO";
 char* unitSuiteGPIO2 = "suite_readGPIO";
 char* unitSuiteGPIO3 = "suite_writeGPIO";
+char* unitSuiteGPIO4 = "suite_bulkGPIO";
+char* unitSuiteGPIO5 = "suite_backendGPIO";
+char* unitSuiteGPIO6 = "suite_simGPIO";
 
 char* unitSuiteI2C0 = "suite_setupI2C";
 
@@ -34,6 +40,10 @@ void init_I2C_test(){
     gpioChip.numGPIOLines = NUM_LINES_TO_USE;
     gpioChip.isSetup = 0;
 
+    if(getBackendGPIO() == SIM){
+        addI2CDeviceSim(AT24C16, DEFAULT_I2C_BUS, I2C_ID);
+    }
+
     setupGPIO(&gpioChip);
     setPinModeGPIO(&gpioChip,13, OUTPUT);
     setPinModeGPIO(&gpioChip,19, OUTPUT);
@@ -487,6 +497,273 @@ void test_writeGPIOInvalidValue(){
     cleanupGPIO(&gpioChip);
 }
 
+// SUITE - Bulk GPIO
+// TEST - Request Bulk when gpio has not been setup
+void test_requestBulkGPIOWithoutSetup(){
+    init_gpio_test();
+
+    unit_test_actual_result = requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, OUTPUT, 0);
+    unit_test_expected = -1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Request Bulk as Output
+void test_requestBulkGPIOAsOutput(){
+    init_gpio_test();
+
+    setupGPIO(&gpioChip);
+    unit_test_actual_result = requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, OUTPUT, 0);
+    unit_test_expected = 0;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Request Bulk builds the register lookup tables
+void test_requestBulkGPIOLookupTables(){
+    init_gpio_test();
+
+    // bulkLines = {13, 19, 26, 2}
+    setupGPIO(&gpioChip);
+    requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, OUTPUT, 0);
+    unit_test_actual_result = (gpioBulk.setMasks[0][0x5] == ((1u << 13) | (1u << 26))) + \
+                                (gpioBulk.lineMask == ((1u << 13) | (1u << 19) | (1u << 26) | (1u << 2))) + \
+                                (gpioBulk.registerLevels[0][1 << 2] == 0x8) + \
+                                (gpioBulk.registerLevels[2][1 << (19-16)] == 0x2);
+    unit_test_expected = 4;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Request Bulk with too many lines
+void test_requestBulkGPIOTooManyLines(){
+    init_gpio_test();
+
+    setupGPIO(&gpioChip);
+    unit_test_actual_result = requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, MAX_BULK_LINES+1, OUTPUT, 0);
+    unit_test_expected = -1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Request Bulk with a line already in a bulk
+void test_requestBulkGPIOTwice(){
+    struct GPIO_BULK otherBulk;
+    init_gpio_test();
+
+    setupGPIO(&gpioChip);
+    requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, OUTPUT, 0);
+    unit_test_actual_result = requestBulkGPIO(&gpioChip, &otherBulk, bulkLines, 2, OUTPUT, 0);
+    unit_test_expected = -1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Write Bulk set to Output
+void test_writeBulkGPIOSetToOutput(){
+    init_gpio_test();
+
+    setupGPIO(&gpioChip);
+    requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, OUTPUT, 0);
+    unit_test_actual_result = writeBulkGPIO(&gpioChip, &gpioBulk, 0xA);
+    unit_test_expected = -1;
+    expectNot(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Write Bulk set to Input
+void test_writeBulkGPIOSetToInput(){
+    init_gpio_test();
+
+    setupGPIO(&gpioChip);
+    requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, INPUT, 0);
+    unit_test_actual_result = writeBulkGPIO(&gpioChip, &gpioBulk, 0xA);
+    unit_test_expected = -1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Read Bulk set to Input
+void test_readBulkGPIOSetToInput(){
+    init_gpio_test();
+
+    setupGPIO(&gpioChip);
+    requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, OUTPUT, 0);
+    setBulkModeGPIO(&gpioChip, &gpioBulk, INPUT);
+    unit_test_actual_result = readBulkGPIO(&gpioChip, &gpioBulk);
+    unit_test_expected = -1;
+    expectNot(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Set Pin Mode of a line in a Bulk
+void test_setPinModeGPIOOfBulkLine(){
+    init_gpio_test();
+
+    setupGPIO(&gpioChip);
+    requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, OUTPUT, 0);
+    unit_test_actual_result = setPinModeGPIO(&gpioChip, bulkLines[0], INPUT);
+    unit_test_expected = -1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// TEST - Write GPIO of a line in a Bulk
+void test_writeGPIOOfBulkLine(){
+    init_gpio_test();
+
+    setupGPIO(&gpioChip);
+    requestBulkGPIO(&gpioChip, &gpioBulk, bulkLines, 4, OUTPUT, 0);
+    writeGPIO(&gpioChip, bulkLines[2], HIGH);
+    unit_test_actual_result = gpioBulk.values[2] + gpioBulk.values[0];
+    unit_test_expected = 1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+}
+
+// SUITE - Backend GPIO
+// TEST - Set Backend to gpiomem
+void test_setBackendGPIOToGPIOMem(){
+    int backend = getBackendGPIO();
+
+    unit_test_actual_result = setBackendGPIO(GPIOMEM) + getBackendGPIO();
+    unit_test_expected = GPIOMEM;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    setBackendGPIO(backend);
+}
+
+// TEST - Set Backend to invalid value
+void test_setBackendGPIOInvalid(){
+    int backend = getBackendGPIO();
+
+    unit_test_actual_result = setBackendGPIO(-1);
+    unit_test_expected = -1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    setBackendGPIO(backend);
+}
+
+// SUITE - Simulated EEPROM
+// TEST - Setup GPIO with the simulated backend
+void test_setupGPIOSim(){
+    int backend = getBackendGPIO();
+    init_gpio_test();
+    setBackendGPIO(SIM);
+
+    unit_test_actual_result = setupGPIO(&gpioChip);
+    unit_test_expected = 0;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+    setBackendGPIO(backend);
+}
+
+// TEST - Simulated I2C device does not ACK during a write cycle
+void test_writeI2CSimDuringWriteCycle(){
+    int backend = getBackendGPIO();
+    char buf[] = {0x00, 0x10, 0x5A};
+    setBackendGPIO(SIM);
+    setWriteCycleTimeSim(100000);
+    addI2CDeviceSim(AT24C16, DEFAULT_I2C_BUS, I2C_ID);
+    int fd = setupI2C(DEFAULT_I2C_BUS, I2C_ID);
+
+    writeI2C(fd, buf, 3);
+    unit_test_actual_result = writeI2C(fd, NULL, 0);
+    unit_test_expected = -1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupI2C(fd);
+    setWriteCycleTimeSim(-1);
+    setBackendGPIO(backend);
+}
+
+// TEST - Read back a byte written to a simulated I2C device
+void test_readI2CSimAfterWriteCycle(){
+    int backend = getBackendGPIO();
+    char buf[] = {0x00, 0x20, 0x3C};
+    setBackendGPIO(SIM);
+    setWriteCycleTimeSim(100);
+    addI2CDeviceSim(AT24C16, DEFAULT_I2C_BUS, I2C_ID);
+    int fd = setupI2C(DEFAULT_I2C_BUS, I2C_ID);
+
+    writeI2C(fd, buf, 3);
+    usleep(1000);
+    buf[0] = 0x00;
+    buf[1] = 0x20;
+    readI2C(fd, buf, 1, 2);
+    unit_test_actual_result = buf[0];
+    unit_test_expected = 0x3C;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupI2C(fd);
+    setWriteCycleTimeSim(-1);
+    setBackendGPIO(backend);
+}
+
+// TEST - Set Pin Mode already in effect does not reach the backend
+void test_setPinModeGPIOSimAlreadyInEffect(){
+    int backend = getBackendGPIO();
+    struct SIM_STATS stats;
+    init_gpio_test();
+    setBackendGPIO(SIM);
+    setupGPIO(&gpioChip);
+
+    resetStatsSim();
+    setPinModeGPIO(&gpioChip, 0, INPUT);
+    setPinModeGPIO(&gpioChip, 0, INPUT);
+    getStatsSim(&stats);
+    unit_test_actual_result = stats.gpioOps;
+    unit_test_expected = 1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+    setBackendGPIO(backend);
+}
+
+// TEST - Write GPIO level already in effect does not reach the backend
+void test_writeGPIOSimAlreadyInEffect(){
+    int backend = getBackendGPIO();
+    struct SIM_STATS stats;
+    init_gpio_test();
+    setBackendGPIO(SIM);
+    setupGPIO(&gpioChip);
+
+    resetStatsSim();
+    writeGPIO(&gpioChip, 0, LOW);
+    writeGPIO(&gpioChip, 0, HIGH);
+    writeGPIOUnchecked(&gpioChip, 0, HIGH);
+    getStatsSim(&stats);
+    unit_test_actual_result = stats.gpioOps;
+    unit_test_expected = 1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    cleanupGPIO(&gpioChip);
+    setBackendGPIO(backend);
+}
+
+// TEST - Setup I2C with no simulated device
+void test_setupI2CSimWithNoDevice(){
+    int backend = getBackendGPIO();
+    setBackendGPIO(SIM);
+
+    unit_test_actual_result = setupI2C(DEFAULT_I2C_BUS, 0x57);
+    unit_test_expected = -1;
+    expect(unit_test_expected,unit_test_actual_result);
+
+    setBackendGPIO(backend);
+}
+
 /******************************************************************************/
 /******************************** I2C Tests ***********************************/
 /******************************************************************************/
@@ -497,7 +774,7 @@ void test_setupI2CWithWrongID(){
     init_I2C_test();
     int wrongI2cId = 0x55;
     
-    unit_test_actual_result = setupI2C(wrongI2cId);
+    unit_test_actual_result = setupI2C(DEFAULT_I2C_BUS, wrongI2cId);
     unit_test_expected = -1;
     expect(unit_test_expected,unit_test_actual_result);
 
@@ -508,7 +785,7 @@ void test_setupI2CWithWrongID(){
 void test_setupI2C(){
     init_I2C_test();
     
-    unit_test_actual_result = setupI2C(I2C_ID);
+    unit_test_actual_result = setupI2C(DEFAULT_I2C_BUS, I2C_ID);
     unit_test_expected = -1;
     expectNot(unit_test_expected,unit_test_actual_result);
 
@@ -519,8 +796,8 @@ void test_setupI2C(){
 void test_setupI2CTwice(){
     init_I2C_test();
     
-    setupI2C(I2C_ID);
-    unit_test_actual_result = setupI2C(I2C_ID);
+    setupI2C(DEFAULT_I2C_BUS, I2C_ID);
+    unit_test_actual_result = setupI2C(DEFAULT_I2C_BUS, I2C_ID);
     unit_test_expected = -1;
     expectNot(unit_test_expected,unit_test_actual_result);
 
@@ -572,6 +849,30 @@ int run_gpio_tests(int suiteToRun, int testToRun){
     addUnitTest("Write GPIO with Line Out of Range", getCurrentUnitSuite(), test_writeGPIOLineOutOfRange);
     addUnitTest("Write GPIO with invalid value", getCurrentUnitSuite(), test_writeGPIOInvalidValue);
 
+    addUnitSuite(unitSuiteGPIO4);
+    addUnitTest("Request Bulk when gpio has not been setup", getCurrentUnitSuite(), test_requestBulkGPIOWithoutSetup);
+    addUnitTest("Request Bulk as Output", getCurrentUnitSuite(), test_requestBulkGPIOAsOutput);
+    addUnitTest("Request Bulk builds the register lookup tables", getCurrentUnitSuite(), test_requestBulkGPIOLookupTables);
+    addUnitTest("Request Bulk with too many lines", getCurrentUnitSuite(), test_requestBulkGPIOTooManyLines);
+    addUnitTest("Request Bulk with a line already in a bulk", getCurrentUnitSuite(), test_requestBulkGPIOTwice);
+    addUnitTest("Write Bulk set to Output", getCurrentUnitSuite(), test_writeBulkGPIOSetToOutput);
+    addUnitTest("Write Bulk set to Input", getCurrentUnitSuite(), test_writeBulkGPIOSetToInput);
+    addUnitTest("Read Bulk set to Input", getCurrentUnitSuite(), test_readBulkGPIOSetToInput);
+    addUnitTest("Set Pin Mode of a line in a Bulk", getCurrentUnitSuite(), test_setPinModeGPIOOfBulkLine);
+    addUnitTest("Write GPIO of a line in a Bulk", getCurrentUnitSuite(), test_writeGPIOOfBulkLine);
+
+    addUnitSuite(unitSuiteGPIO5);
+    addUnitTest("Set Backend to gpiomem", getCurrentUnitSuite(), test_setBackendGPIOToGPIOMem);
+    addUnitTest("Set Backend to invalid value", getCurrentUnitSuite(), test_setBackendGPIOInvalid);
+
+    addUnitSuite(unitSuiteGPIO6);
+    addUnitTest("Setup GPIO with the simulated backend", getCurrentUnitSuite(), test_setupGPIOSim);
+    addUnitTest("Simulated I2C device does not ACK during a write cycle", getCurrentUnitSuite(), test_writeI2CSimDuringWriteCycle);
+    addUnitTest("Read back a byte written to a simulated I2C device", getCurrentUnitSuite(), test_readI2CSimAfterWriteCycle);
+    addUnitTest("Setup I2C with no simulated device", getCurrentUnitSuite(), test_setupI2CSimWithNoDevice);
+    addUnitTest("Set Pin Mode already in effect is skipped", getCurrentUnitSuite(), test_setPinModeGPIOSimAlreadyInEffect);
+    addUnitTest("Write GPIO level already in effect is skipped", getCurrentUnitSuite(), test_writeGPIOSimAlreadyInEffect);
+
 
     runUnitTests(suiteToRun,testToRun);
 
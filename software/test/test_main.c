@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "../include/piepro.h" // For END and EEPROM_MODEL_STRINGS
+#include "../include/gpio.h" // For setBackendGPIO
 
 int main(int argc,char *argv[]){
     int testType = 0;
@@ -37,6 +38,11 @@ int main(int argc,char *argv[]){
             testType = 1;
         }
 
+        // -sim
+        if (!strcmp(argv[i], "-sim")){
+            setBackendGPIO(SIM);
+        }
+
         // -l --limit
         if (!strcmp(argv[i], "-l") || !strcmp(argv[i], "--limit")){
             if (i != argc-1) {